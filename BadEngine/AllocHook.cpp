@@ -0,0 +1,143 @@
+#include "AllocTracker.h"
+
+// the global operator new and delete, replaced only in BE_TRACK_ALLOCS builds. Benchmarks
+// compiles this file itself with BE_TRACK_ALLOCS, BadEngine.lib stays uninstrumented.
+#ifdef BE_TRACK_ALLOCS
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include <new>
+
+static void *counted_alloc(size_t size)
+{
+  AllocTracker::count_alloc(size);
+
+  // malloc(0) may return null, new must not.
+  void *p = std::malloc(size ? size : 1);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+// posix_memalign's memory is freed with free(), _aligned_malloc's needs _aligned_free().
+static void *aligned_malloc(size_t size, std::align_val_t alignment)
+{
+#ifdef _WIN32
+  return _aligned_malloc(size ? size : 1, (size_t)alignment);
+#else
+  void *p = nullptr;
+  return posix_memalign(&p, (size_t)alignment, size ? size : 1) == 0 ? p : nullptr;
+#endif
+}
+
+static void aligned_free(void *p)
+{
+#ifdef _WIN32
+  _aligned_free(p);
+#else
+  std::free(p);
+#endif
+}
+
+static void *counted_aligned_alloc(size_t size, std::align_val_t alignment)
+{
+  AllocTracker::count_alloc(size);
+
+  void *p = aligned_malloc(size, alignment);
+  if (!p)
+  {
+    throw std::bad_alloc();
+  }
+
+  return p;
+}
+
+void *operator new(size_t size)
+{
+  return counted_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+  return counted_alloc(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+  AllocTracker::count_alloc(size);
+  return std::malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+  AllocTracker::count_alloc(size);
+  return std::malloc(size ? size : 1);
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+  std::free(p);
+}
+
+// over-aligned types, e.g. SpscRing's cache line aligned indices.
+void *operator new(size_t size, std::align_val_t alignment)
+{
+  return counted_aligned_alloc(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+  return counted_aligned_alloc(size, alignment);
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  AllocTracker::count_alloc(size);
+  return aligned_malloc(size, alignment);
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+  AllocTracker::count_alloc(size);
+  return aligned_malloc(size, alignment);
+}
+
+void operator delete(void *p, std::align_val_t) noexcept
+{
+  aligned_free(p);
+}
+
+void operator delete[](void *p, std::align_val_t) noexcept
+{
+  aligned_free(p);
+}
+
+void operator delete(void *p, size_t, std::align_val_t) noexcept
+{
+  aligned_free(p);
+}
+
+void operator delete[](void *p, size_t, std::align_val_t) noexcept
+{
+  aligned_free(p);
+}
+#endif
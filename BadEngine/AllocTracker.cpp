@@ -0,0 +1,117 @@
+#include "AllocTracker.h"
+
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+  std::atomic<uint64_t> total_allocs{ 0 };
+  std::atomic<uint64_t> total_bytes{ 0 };
+  // trivial, so reading it never allocates.
+  thread_local AllocTracker::Counts thread_counts;
+}
+
+AllocTracker &AllocTracker::get()
+{
+  static AllocTracker tracker;
+  return tracker;
+}
+
+AllocTracker::Counts AllocTracker::get_thread_counts()
+{
+  return thread_counts;
+}
+
+void AllocTracker::count_alloc(size_t size)
+{
+  total_allocs.fetch_add(1, std::memory_order_relaxed);
+  total_bytes.fetch_add(size, std::memory_order_relaxed);
+  thread_counts.allocs++;
+  thread_counts.bytes += size;
+}
+
+AllocTracker::Counts AllocTracker::get_total_counts()
+{
+  return Counts{ total_allocs.load(std::memory_order_relaxed), total_bytes.load(std::memory_order_relaxed) };
+}
+
+void AllocTracker::begin_step()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  for (PhaseSum &phase : phases_)
+    phase.counts = Counts{};
+
+  step_start_ = get_total_counts();
+}
+
+void AllocTracker::end_step()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  Counts end = get_total_counts();
+  step_counts_ = Counts{ end.allocs - step_start_.allocs, end.bytes - step_start_.bytes };
+
+  const size_t step = steps_n_++;
+  if (steady_state_ && step >= steady_from_step_ && step_counts_.allocs > 0)
+  {
+    // the message allocates, the step failed already.
+    throw std::runtime_error("allocations in steady-state step " + std::to_string(step) + ": " + describe_step());
+  }
+}
+
+void AllocTracker::add_phase(const char *name, const Counts &counts)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  // few phases, literals usually compare equal by address.
+  for (PhaseSum &phase : phases_)
+  {
+    if (phase.name == name || strcmp(phase.name, name) == 0)
+    {
+      phase.counts.allocs += counts.allocs;
+      phase.counts.bytes += counts.bytes;
+      return;
+    }
+  }
+
+  phases_.push_back(PhaseSum{ name, counts });
+}
+
+void AllocTracker::set_steady_state(size_t warmup_steps)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  steady_state_ = true;
+  steady_from_step_ = steps_n_ + warmup_steps;
+}
+
+AllocTracker::Counts AllocTracker::get_step_counts() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return step_counts_;
+}
+
+std::vector<AllocTracker::Phase> AllocTracker::get_phases() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<Phase> phases;
+  for (const PhaseSum &phase : phases_)
+    phases.push_back(Phase{ phase.name, phase.counts });
+
+  return phases;
+}
+
+std::string AllocTracker::describe_step() const
+{
+  std::string s = std::to_string(step_counts_.allocs) + " allocations, " + std::to_string(step_counts_.bytes) + " bytes";
+  for (const PhaseSum &phase : phases_)
+  {
+    if (phase.counts.allocs > 0)
+      s += "; " + std::string(phase.name) + ": " + std::to_string(phase.counts.allocs) + " allocations, " + std::to_string(phase.counts.bytes) + " bytes";
+  }
+
+  return s;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Counts calls to the global operator new, which AllocHook.cpp replaces in BE_TRACK_ALLOCS
+ * builds; Benchmarks compiles the hook itself. A step is what runs between begin_step()
+ * and end_step(). Its phases are the profiler scopes that ended inside it, so phases need
+ * BE_PROFILE too; a phase counts the allocations of its nested scopes as well.
+ *
+ * In steady-state mode a step that allocates after the warm-up steps makes end_step() throw,
+ * naming the phases that allocated. This keeps the optimised hot loop allocation free.
+ *
+ * Use the macros, they compile to nothing without BE_TRACK_ALLOCS:
+ *   ALLOC_BEGIN_STEP();
+ *   ...                  // PROFILE_SCOPE("solver") etc.
+ *   ALLOC_END_STEP();
+ */
+class AllocTracker
+{
+public:
+  struct Counts
+  {
+    uint64_t allocs = 0;
+    uint64_t bytes = 0;
+  };
+
+  struct Phase
+  {
+    std::string name;
+    Counts counts;
+  };
+
+public:
+  static AllocTracker &get();
+  // of the calling thread, since it started.
+  static Counts get_thread_counts();
+  // of all threads, since the process started.
+  static Counts get_total_counts();
+  // called by the operator new hook, never allocates.
+  static void count_alloc(size_t size);
+
+  void begin_step();
+  // throws std::runtime_error in steady-state mode if the step allocated past the warm-up.
+  void end_step();
+  // called by ProfileScope, any thread.
+  void add_phase(const char *name, const Counts &counts);
+
+  // after warmup_steps more steps, any allocation in a step fails the run.
+  void set_steady_state(size_t warmup_steps);
+  bool is_steady_state() const { return steady_state_; }
+
+  // of the last step.
+  Counts get_step_counts() const;
+  // of the last step, in order of first appearance, phases that didn't run have 0.
+  std::vector<Phase> get_phases() const;
+
+private:
+  AllocTracker() = default;
+
+  struct PhaseSum
+  {
+    const char *name;
+    Counts counts;
+  };
+
+  std::string describe_step() const;
+
+private:
+  mutable std::mutex mutex_;
+  // kept across steps and reset in place, a step only allocates here the first time it sees a phase.
+  std::vector<PhaseSum> phases_;
+  Counts step_start_;
+  Counts step_counts_;
+  size_t steps_n_ = 0;
+
+  bool steady_state_ = false;
+  size_t steady_from_step_ = 0;
+};
+
+#ifdef BE_TRACK_ALLOCS
+#define ALLOC_BEGIN_STEP() AllocTracker::get().begin_step()
+#define ALLOC_END_STEP() AllocTracker::get().end_step()
+#else
+#define ALLOC_BEGIN_STEP() ((void)0)
+#define ALLOC_END_STEP() ((void)0)
+#endif
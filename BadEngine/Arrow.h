@@ -2,26 +2,17 @@
 
 #include "gl_incs.h"
 #include "utils.h"
-#include "State.h"
+#include "Shape.h"
 
 class Arrow : public Shape
 {
 public:
-  Arrow(Accessor<State> state_acc,
+  Arrow(World &world,
         const glm::vec3 &pos,
-        const glm::vec3 &dims) : Shape(state_acc, dims),
+        const glm::vec3 &dims) : Shape(world, Geometry::Type::arrow, pos, dims),
                                  pos_start(pos),
                                  vel_start(0.f)
   {
-    set_vel(vel_start);
-    set_pos(pos_start);
-    static constexpr float ANGLE = 0.f;
-    float half_angle = 0.5f * (utility::PI * 0.f);
-
-    set_orientation(glm::normalize((glm::quat(cos(half_angle),
-                                              sin(half_angle) * 1.f,
-                                              sin(half_angle) * 0.f,
-                                              sin(half_angle) * 0.f))));
   }
 
   void orient(const glm::vec3 &dir)
@@ -42,15 +33,6 @@ public:
     }
   }
 
-private:
-  virtual Collidable create_collidable(float mass) const override
-  {
-    throw std::runtime_error("not implemented");
-    glm::mat3 IBody = glm::identity<glm::mat3>(); // DUDU implement
-
-    return Collidable(Collidable::Type::arrow, mass, IBody);
-  }
-
 public:
   glm::vec3 pos_start;
   glm::vec3 vel_start;
@@ -2,6 +2,10 @@
 #include <iostream>
 #include <sstream>
 #include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
 
 #include "gl_incs.h"
 
@@ -9,6 +13,9 @@
 #include "BadEngine.h"
 #include "coords.h"
 #include "Shader.h"
+#include "BinaryMesh.h"
+#include "MeshGen.h"
+#include "Profiler.h"
 
 namespace gl_cbs
 {
@@ -50,132 +57,148 @@ BadEngine::~BadEngine()
     gl_cbs::p_camera = nullptr;
   }
 
-  spheres_.erase(spheres_.begin(), spheres_.end());
+  // shapes remove their entities from world_ as they go.
+  spheres_.clear();
+  boxes_.clear();
+  lines_.clear();
+  arrows_.clear();
+  sphere_pool_.clear();
+  box_pool_.clear();
+  line_pool_.clear();
+  arrow_pool_.clear();
 }
 
-void BadEngine::init_sphere_program()
+// binding point of the Frame uniform block, see frame_uniforms.glsl.
+static constexpr GLuint FRAME_UNIFORMS_BINDING = 0;
+// world position of the single light.
+static const glm::vec3 LIGHT_POS(1.2f, 3.f, 2.f);
+
+// largest distance of a vertex from the origin, vertices start with a position.
+static float get_bounding_radius(const float *vertices, size_t vertices_n, size_t stride)
 {
-  parser_.parse("SphereRad1.obj");
+  float radius = 0.f;
 
-  std::vector<float> sphere_data = parser_.get_data();
-  std::vector<unsigned int> sphere_indices = parser_.get_indices();
+  for (size_t i = 0; i < vertices_n; ++i)
+  {
+    radius = std::max(radius, glm::length(glm::make_vec3(vertices + i * stride)));
+  }
 
-  size_t sphere_count = sphere_indices.size();
-  GLuint sphere_vao = 0;
+  return radius;
+}
 
-  glGenVertexArrays(1, &sphere_vao);
-  glBindVertexArray(sphere_vao);
+void BadEngine::init_sphere_program()
+{
+  // the finest lod first, each next one halves the detail.
+  static constexpr size_t MAX_LODS = 4;
+  // minimal projected radius in pixels of lods 0-2.
+  static constexpr float LOD_MIN_PIXELS[MAX_LODS - 1] = { 48.f, 16.f, 6.f };
+  static constexpr unsigned int MIN_UV_SEGMENTS = 6;
 
-  GLuint sphere_vbos[2];
+  if (sphere_mesh_ == SphereMesh::obj)
+  {
+    init_sphere_mesh_from_obj();
+    return;
+  }
 
-  glGenBuffers(sizeof(sphere_vbos) / sizeof(sphere_vbos[0]),
-               sphere_vbos);
-  glBindBuffer(GL_ARRAY_BUFFER,
-               sphere_vbos[0]);
-  glBufferData(GL_ARRAY_BUFFER,
-               sphere_data.size() * sizeof(sphere_data[0]),
-               &sphere_data[0],
-               GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphere_vbos[1]);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-               sphere_indices.size() * sizeof(sphere_indices[0]),
-               &sphere_indices[0],
-               GL_STATIC_DRAW);
+  const bool is_icosphere = sphere_mesh_ == SphereMesh::icosphere;
+  unsigned int detail = sphere_mesh_detail_;
+  std::vector<GeometryBuffer::MeshRange> lods;
+  float bounding_radius = 0.f;
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void *>(0));
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+  // generated, no file is read.
+  while (lods.size() < MAX_LODS)
+  {
+    std::vector<float> lod_data;
+    std::vector<unsigned int> lod_indices;
+    size_t stride;
 
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
+    if (is_icosphere)
+    {
+      mesh_gen::icosphere(detail, lod_data, lod_indices);
+      stride = 6;
+    }
+    else
+    {
+      mesh_gen::uv_sphere(detail, detail / 2, lod_data, lod_indices);
+      stride = 8;
+    }
 
-  Shader sphere_shader_programm("base_vs.glsl", "base_fs.glsl");
+    lods.push_back(geometry_->add_mesh(lod_data.data(), lod_data.size() / stride, stride, lod_indices.data(), lod_indices.size()));
+    bounding_radius = std::max(bounding_radius, get_bounding_radius(lod_data.data(), lod_data.size() / stride, stride));
 
-  if (sphere_shader_programm.get_error())
-  {
-    auto msgv = sphere_shader_programm.get_message();
-    msg_ = VMSG_TO_STR(msgv);
-    status_ = sphere_shader_programm.get_error() ? R_FAILURE : R_SUCCESS;
+    if (is_icosphere ? detail == 0 : detail / 2 < MIN_UV_SEGMENTS)
+    {
+      break;
+    }
+    detail = is_icosphere ? detail - 1 : detail / 2;
   }
 
-  RenderData render_data{ sphere_vao, sphere_count, sphere_shader_programm, true, glm::vec3(1., .5, .31) };
+  // spheres are always uniformly scaled.
+  RenderData render_data{ lods, ShapeVariant::uniform_scale, glm::vec3(1., .5, .31), bounding_radius,
+                          std::vector<float>(LOD_MIN_PIXELS, LOD_MIN_PIXELS + lods.size() - 1) };
 
   render_data_.emplace(RenderableType::sphere, render_data);
 }
 
-void BadEngine::init_boxes_program()
+void BadEngine::init_sphere_mesh_from_obj()
 {
-  size_t box_count = sizeof(cube_coords_w_normals_n_textures) / sizeof(cube_coords_w_normals_n_textures[0]);
-  GLuint box_vao = 0;
-  glGenVertexArrays(1, &box_vao);
-  glBindVertexArray(box_vao);
+  std::unique_ptr<BinaryMesh> mesh;
+  try
+  {
+    mesh = std::make_unique<BinaryMesh>(sphere_mesh_path_);
+  }
+  catch (const std::runtime_error &e)
+  {
+    status_ = R_FAILURE;
+    msg_ = e.what();
+    return;
+  }
 
-  GLuint box_vbo;
+  static constexpr size_t STRIDE = BinaryMesh::VERTEX_SIZE;
+  GeometryBuffer::MeshRange lod = geometry_->add_mesh(mesh->get_vertices(), mesh->get_vertices_n(), STRIDE,
+                                                      mesh->get_indices(), mesh->get_indices_n());
+  float bounding_radius = get_bounding_radius(mesh->get_vertices(), mesh->get_vertices_n(), STRIDE);
 
-  glGenBuffers(1, &box_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, box_vbo);
-  glBufferData(GL_ARRAY_BUFFER,
-               sizeof(cube_coords_w_normals_n_textures),
-               cube_coords_w_normals_n_textures,
-               GL_STATIC_DRAW);
+  RenderData render_data{ { lod }, ShapeVariant::uniform_scale, glm::vec3(1., .5, .31), bounding_radius, {} };
+
+  render_data_.emplace(RenderableType::sphere, render_data);
+}
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0));
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0 + 3 * sizeof(GLfloat)));
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0 + 6 * sizeof(GLfloat)));
+// the un-indexed triangle lists of coords.h, welded into indexed meshes.
+static GeometryBuffer::MeshRange add_triangle_list(GeometryBuffer &geometry, const float *vertices, size_t vertices_n, size_t stride)
+{
+  std::vector<float> welded;
+  std::vector<unsigned int> indices;
+  mesh_gen::weld(vertices, vertices_n, stride, welded, indices);
 
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glEnableVertexAttribArray(2);
+  return geometry.add_mesh(welded.data(), welded.size() / stride, stride, indices.data(), indices.size());
+}
 
-  Shader box_shader_program = Shader("base_vs.glsl", "base_fs.glsl");
+void BadEngine::init_boxes_program()
+{
+  static constexpr size_t VERTEX_SIZE = 8;
+  size_t box_count = sizeof(cube_coords_w_normals_n_textures) / (VERTEX_SIZE * sizeof(cube_coords_w_normals_n_textures[0]));
 
-  if (box_shader_program.get_error())
-  {
-    auto msgv = box_shader_program.get_message();
-    msg_ = VMSG_TO_STR(msgv);
-    status_ = false;
-  }
+  GeometryBuffer::MeshRange mesh = add_triangle_list(*geometry_, cube_coords_w_normals_n_textures, box_count, VERTEX_SIZE);
+  float bounding_radius = get_bounding_radius(cube_coords_w_normals_n_textures, box_count, VERTEX_SIZE);
 
-  RenderData render_data{ box_vao, box_count, box_shader_program, false, glm::vec3(1., .5, .71) };
+  RenderData render_data{ { mesh }, ShapeVariant::general, glm::vec3(1., .5, .71), bounding_radius, {} };
 
   render_data_.emplace(RenderableType::box, render_data);
 }
 
 void BadEngine::init_lines_program()
 {
-  // normalized coordinated of 0-->1 vector
-  static constexpr float VERTICES[] = {
-    0.f,          //s.x
-    0.f,          //s.y
-    0.f,          //s.z
-    0.577350259f, // e.x
-    0.577350259f, // e.y
-    0.577350259f  // e.z
-  };
-
-  glGenVertexArrays(1, &line_vao_);
-  glBindVertexArray(line_vao_);
-
-  GLuint line_vbo;
-
-  glGenBuffers(1, &line_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, line_vbo);
-  glBufferData(GL_ARRAY_BUFFER,
-               sizeof(VERTICES),
-               VERTICES,
-               GL_STATIC_DRAW);
-
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), reinterpret_cast<void *>(0));
+  line_batch_ = std::make_unique<LineBatch>(*shaders_);
 
-  glEnableVertexAttribArray(0);
+  init_program(line_batch_->get_program());
+}
 
-  line_shader_programme_ = Shader("base_vs.glsl", "base_fs.glsl");
+void BadEngine::init_profiler_overlay()
+{
+  profiler_overlay_ = std::make_unique<ProfilerOverlay>(*shaders_, screen_width_, screen_height_);
 
-  if (line_shader_programme_.get_error())
-  {
-    auto msgv = line_shader_programme_.get_message();
-    msg_ = VMSG_TO_STR(msgv);
-    status_ = false;
-  }
+  init_program(profiler_overlay_->get_program());
 }
 
 void BadEngine::init_cube_program()
@@ -202,57 +225,71 @@ void BadEngine::init_cube_program()
 
   glEnableVertexAttribArray(0);
 
-  cube_shader_programme_ = Shader("containing_cube_vs.glsl", "containing_cube_fs.glsl");
+  cube_shader_programme_ = shaders_->get("containing_cube_vs.glsl", "containing_cube_fs.glsl");
 
-  if (cube_shader_programme_.get_error())
-  {
-    auto msgv = cube_shader_programme_.get_message();
-    msg_ = VMSG_TO_STR(msgv);
-    status_ = cube_shader_programme_.get_error() ? R_FAILURE : R_SUCCESS;
-  }
+  init_program(cube_shader_programme_);
+
+  cube_model_location_ = cube_shader_programme_.get_location("model");
 }
 
 void BadEngine::init_arrows_program()
 {
-  size_t arrow_count = sizeof(arrow_coords_w_normals_n_textures) / sizeof(arrow_coords_w_normals_n_textures[0]);
+  static constexpr size_t VERTEX_SIZE = 8;
+  size_t arrow_count = sizeof(arrow_coords_w_normals_n_textures) / (VERTEX_SIZE * sizeof(arrow_coords_w_normals_n_textures[0]));
 
-  GLuint arrow_vao = 0;
-  GLuint arrow_vbo;
+  GeometryBuffer::MeshRange mesh = add_triangle_list(*geometry_, arrow_coords_w_normals_n_textures, arrow_count, VERTEX_SIZE);
+  float bounding_radius = get_bounding_radius(arrow_coords_w_normals_n_textures, arrow_count, VERTEX_SIZE);
 
-  glGenVertexArrays(1, &arrow_vao);
-  glBindVertexArray(arrow_vao);
+  RenderData render_data{ { mesh }, ShapeVariant::general, glm::vec3(0.f, 1.f, 0.f), bounding_radius, {} };
 
+  render_data_.emplace(RenderableType::arrow, render_data);
+}
 
-  glGenBuffers(1, &arrow_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, arrow_vbo);
-  glBufferData(GL_ARRAY_BUFFER,
-               sizeof(arrow_coords_w_normals_n_textures),
-               arrow_coords_w_normals_n_textures,
-               GL_STATIC_DRAW);
+void BadEngine::init_impostor_program()
+{
+  // corners in the quad's plane, see impostor_vs.glsl. the normal is unused.
+  static constexpr float QUAD[] = {
+    -1.f, -1.f, 0.f, 0.f, 0.f, 1.f,
+    1.f, -1.f, 0.f, 0.f, 0.f, 1.f,
+    -1.f, 1.f, 0.f, 0.f, 0.f, 1.f,
+    1.f, 1.f, 0.f, 0.f, 0.f, 1.f
+  };
+  static constexpr unsigned int QUAD_INDICES[] = { 0, 1, 2, 2, 1, 3 };
 
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0));
-  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0 + 3 * sizeof(GLfloat)));
-  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(GLfloat), reinterpret_cast<void *>(0 + 6 * sizeof(GLfloat)));
+  impostor_quad_ = geometry_->add_mesh(QUAD, 4, 6, QUAD_INDICES, sizeof(QUAD_INDICES) / sizeof(QUAD_INDICES[0]));
+}
 
-  glEnableVertexAttribArray(0);
-  glEnableVertexAttribArray(1);
-  glEnableVertexAttribArray(2);
+void BadEngine::init_shape_programs()
+{
+  shape_programs_[(size_t)ShapeVariant::general] = shaders_->get("instanced_vs.glsl", "base_fs.glsl");
+  shape_programs_[(size_t)ShapeVariant::uniform_scale] = shaders_->get("instanced_vs.glsl", "base_fs.glsl", { "UNIFORM_SCALE" });
+  shape_programs_[(size_t)ShapeVariant::impostor] = shaders_->get("impostor_vs.glsl", "impostor_fs.glsl");
 
-  Shader arrow_shader_program("base_vs.glsl", "base_fs.glsl");
+  for (Shader &program : shape_programs_)
+  {
+    init_program(program);
+  }
 
-  if (arrow_shader_program.get_error())
+  // all meshes were added by now.
+  geometry_->upload();
+  init_instance_attributes();
+}
+
+// reports link errors and attaches the program to the per-frame uniforms.
+void BadEngine::init_program(Shader &program)
+{
+  if (program.get_error())
   {
-    auto msgv = arrow_shader_program.get_message();
+    auto msgv = program.get_message();
     msg_ = VMSG_TO_STR(msgv);
-    status_ = false;
+    status_ = R_FAILURE;
+    return;
   }
 
-  RenderData render_data{ arrow_vao, arrow_count, arrow_shader_program, false, glm::vec3(0.f, 1.f, 0.f) };
-
-  render_data_.emplace(RenderableType::arrow, render_data);
+  program.bind_uniform_block("Frame", FRAME_UNIFORMS_BINDING);
 }
 
-void BadEngine::init()
+void BadEngine::init_window()
 {
   if (glfwInit() == GL_FALSE)
   {
@@ -276,10 +313,49 @@ void BadEngine::init()
 
   glfwMakeContextCurrent(window_);
   glfwSetFramebufferSizeCallback(window_, framebuffer_size_cb);
+}
+
+void BadEngine::init(Backend backend)
+{
+  if (backend == Backend::offscreen)
+  {
+    try
+    {
+      offscreen_ = std::make_unique<OffscreenContext>(screen_width_, screen_height_);
+    }
+    catch (const std::runtime_error &e)
+    {
+      status_ = R_FAILURE;
+      msg_ = e.what();
+      throw;
+    }
+  }
+  else
+  {
+    init_window();
+  }
 
   // start GLEW extension handler
   glewExperimental = GL_TRUE;
-  int res = glewInit();
+  GLenum res = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+  // a glx-built glew has no x display under egl, the context itself is fine
+  if (offscreen_ && res == GLEW_ERROR_NO_GLX_DISPLAY)
+  {
+    res = GLEW_OK;
+  }
+#endif
+  if (res != GLEW_OK)
+  {
+    status_ = R_FAILURE;
+    msg_ = std::string("glewInit failed: ") + reinterpret_cast<const char *>(glewGetErrorString(res));
+    throw std::runtime_error(msg_);
+  }
+
+  if (offscreen_)
+  {
+    offscreen_->init_framebuffer();
+  }
 
   const GLubyte *renderer = glGetString(GL_RENDERER);
   const GLubyte *version = glGetString(GL_VERSION);
@@ -293,7 +369,7 @@ void BadEngine::init()
   glm::vec3 camera_front(-.3f, -.3f, -1.f);
   glm::vec3 world_up(0.f, 1.f, 0.f);
 
-  cam_ = new Camera(window_, camera_pos, camera_front, world_up);
+  cam_ = new Camera(window_, screen_width_, screen_height_, camera_pos, camera_front, world_up);
   gl_cbs::p_camera = cam_;
 
   //parser_.parse("TriangulatedSphere.obj");
@@ -305,11 +381,26 @@ void BadEngine::init()
   // fix alignment for subsequent calls to glReadPixels().
   glPixelStorei(GL_PACK_ALIGNMENT, 1);
 
-  glfwSetInputMode(window_, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-  glfwSetCursorPosCallback(window_, gl_cbs::mouse_drag_cb);
-  glfwSetScrollCallback(window_, gl_cbs::mouse_scroll_cb);
-  glfwSetWindowUserPointer(window_, this);
-  glfwSetKeyCallback(window_, key_callback);
+  if (window_)
+  {
+    glfwSetInputMode(window_, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetCursorPosCallback(window_, gl_cbs::mouse_drag_cb);
+    glfwSetScrollCallback(window_, gl_cbs::mouse_scroll_cb);
+    glfwSetWindowUserPointer(window_, this);
+    glfwSetKeyCallback(window_, key_callback);
+  }
+
+  static constexpr size_t INITIAL_INSTANCES_N = 1024;
+  instance_stream_ = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, INITIAL_INSTANCES_N * sizeof(InstancePose));
+  frame_stream_ = std::make_unique<StreamBuffer>(GL_UNIFORM_BUFFER, sizeof(FrameUniforms));
+  geometry_ = std::make_unique<GeometryBuffer>();
+  shaders_ = std::make_unique<ShaderRegistry>();
+
+  if (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)
+  {
+    static constexpr size_t INITIAL_COMMANDS_N = 64;
+    indirect_stream_ = std::make_unique<StreamBuffer>(GL_DRAW_INDIRECT_BUFFER, INITIAL_COMMANDS_N * sizeof(DrawElementsIndirectCommand));
+  }
 
   init_sphere_program();
 
@@ -345,91 +436,241 @@ void BadEngine::init()
   {
     throw std::runtime_error(msg_);
   }
+
+  init_impostor_program();
+
+  if (status_ != R_SUCCESS)
+  {
+    throw std::runtime_error(msg_);
+  }
+
+  init_shape_programs();
+
+  if (status_ != R_SUCCESS)
+  {
+    throw std::runtime_error(msg_);
+  }
+
+#ifdef BE_PROFILE
+  init_profiler_overlay();
+
+  if (status_ != R_SUCCESS)
+  {
+    throw std::runtime_error(msg_);
+  }
+#endif
+}
+
+// instance attribute locations, see instanced_vs.glsl.
+static constexpr GLuint INSTANCE_POS_LOCATION = 3;
+static constexpr GLuint INSTANCE_ORIENTATION_LOCATION = 4;
+static constexpr GLuint INSTANCE_SCALE_LOCATION = 5;
+static constexpr GLuint INSTANCE_MATERIAL_LOCATION = 6;
+
+void BadEngine::init_instance_attributes()
+{
+  // expects the geometry's vao to be bound, the buffer is attached per frame in bind_instance_attributes().
+  for (GLuint loc : { INSTANCE_POS_LOCATION, INSTANCE_ORIENTATION_LOCATION, INSTANCE_SCALE_LOCATION, INSTANCE_MATERIAL_LOCATION })
+  {
+    glEnableVertexAttribArray(loc);
+    glVertexAttribDivisor(loc, 1);
+  }
+}
+
+void BadEngine::bind_instance_attributes(size_t offset)
+{
+  glBindBuffer(GL_ARRAY_BUFFER, instance_stream_->id());
+
+  glVertexAttribPointer(INSTANCE_POS_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(InstancePose), reinterpret_cast<void *>(offset + offsetof(InstancePose, pos)));
+  glVertexAttribPointer(INSTANCE_ORIENTATION_LOCATION, 4, GL_FLOAT, GL_FALSE, sizeof(InstancePose), reinterpret_cast<void *>(offset + offsetof(InstancePose, orientation)));
+  glVertexAttribPointer(INSTANCE_SCALE_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(InstancePose), reinterpret_cast<void *>(offset + offsetof(InstancePose, scale)));
+  glVertexAttribIPointer(INSTANCE_MATERIAL_LOCATION, 1, GL_UNSIGNED_INT, sizeof(InstancePose), reinterpret_cast<void *>(offset + offsetof(InstancePose, material)));
+}
+
+BadEngine::ShapeVariant BadEngine::get_variant(RenderableType type) const
+{
+  return get_render_mode(type) == RenderMode::impostor ? ShapeVariant::impostor : render_data_.at(type).variant;
 }
 
 void BadEngine::draw_shape_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans)
 {
-  for (const auto &it : models_by_vao_)
+  PROFILE_SCOPE("shapes");
+  PROFILE_GPU_SCOPE("shapes");
+
+  static const std::vector<float> SINGLE_LOD;
+  const InstanceCuller::View cull_view(view_trans, projection_trans, (float)screen_height_);
+  size_t total_visible = 0;
+
+  for (const auto &it : poses_by_vao_)
   {
     const RenderData &render_data = render_data_.at(it.first);
+    const bool is_impostor = get_variant(it.first) == ShapeVariant::impostor;
+    InstanceCuller &culler = cullers_[it.first];
 
-    render_data.program.use();
-    glBindVertexArray(render_data.vao);
+    culler.classify(it.second, render_data.bounding_radius, cull_view, is_impostor ? SINGLE_LOD : render_data.lod_min_pixels);
+    total_visible += culler.get_visible_count();
+  }
 
-    glm::vec3 cam_pos = cam_->get_pos();
+  if (total_visible == 0)
+  {
+    return;
+  }
 
-    render_data.program.set_mat4("view", view_trans);
-    render_data.program.set_mat4("projection", projection_trans);
-    render_data.program.set_vec3("eye_pos", cam_pos);
-    render_data.program.set_vec3("object_color", render_data.object_color);
+  // write this frame's visible poses of all types to one section of the stream, grouped by variant,
+  // and a command per (type, lod) pointing at its poses by base instance.
+  static constexpr size_t VARIANTS_N = (size_t)ShapeVariant::count;
+  std::array<size_t, VARIANTS_N + 1> variant_commands = { 0 };
+  InstancePose *dst = static_cast<InstancePose *>(instance_stream_->begin(total_visible * sizeof(InstancePose)));
+  GLuint base_instance = 0;
 
-    const std::vector<glm::mat4> &models = it.second;
+  draw_commands_.clear();
 
-    for (const glm::mat4 &model : models)
+  for (size_t variant = 0; variant < VARIANTS_N; ++variant)
+  {
+    variant_commands[variant] = draw_commands_.size();
+
+    for (const auto &it : poses_by_vao_)
     {
-      render_data.program.set_mat4("model", glm::value_ptr(model));
-      if (render_data.has_element_array)
+      InstanceCuller &culler = cullers_.at(it.first);
+
+      if ((size_t)get_variant(it.first) != variant || culler.get_visible_count() == 0)
       {
-        glDrawElements(GL_TRIANGLES, (GLsizei)render_data.indices_count, GL_UNSIGNED_INT, NULL);
+        continue;
       }
-      else
+
+      culler.write(it.second, dst + base_instance);
+
+      const RenderData &render_data = render_data_.at(it.first);
+      const bool is_impostor = variant == (size_t)ShapeVariant::impostor;
+      const size_t lods_n = is_impostor ? 1 : render_data.lods.size();
+
+      for (size_t lod = 0; lod < lods_n; ++lod)
       {
-        glDrawArrays(GL_TRIANGLES, 0, (GLsizei)render_data.indices_count);
+        const GLuint instances_n = (GLuint)culler.get_lod_count(lod);
+
+        if (instances_n == 0)
+        {
+          continue;
+        }
+
+        const GeometryBuffer::MeshRange &mesh = is_impostor ? impostor_quad_ : render_data.lods[lod];
+
+        draw_commands_.push_back(DrawElementsIndirectCommand{ mesh.indices_count, instances_n, mesh.first_index, mesh.base_vertex, base_instance });
+        base_instance += instances_n;
       }
     }
   }
+
+  variant_commands[VARIANTS_N] = draw_commands_.size();
+
+  size_t offset = instance_stream_->end();
+
+  glBindVertexArray(geometry_->vao());
+  bind_instance_attributes(offset);
+
+  size_t commands_offset = 0;
+
+  if (indirect_stream_)
+  {
+    const size_t commands_size = draw_commands_.size() * sizeof(DrawElementsIndirectCommand);
+
+    std::memcpy(indirect_stream_->begin(commands_size), draw_commands_.data(), commands_size);
+    commands_offset = indirect_stream_->end();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_stream_->id());
+  }
+
+  for (size_t variant = 0; variant < VARIANTS_N; ++variant)
+  {
+    const size_t first = variant_commands[variant];
+    const size_t count = variant_commands[variant + 1] - first;
+
+    if (count == 0)
+    {
+      continue;
+    }
+
+    shape_programs_[variant].use();
+
+    if (indirect_stream_)
+    {
+      glMultiDrawElementsIndirect(GL_TRIANGLES,
+                                  GL_UNSIGNED_INT,
+                                  reinterpret_cast<void *>(commands_offset + first * sizeof(DrawElementsIndirectCommand)),
+                                  (GLsizei)count,
+                                  0);
+      continue;
+    }
+
+    // no base instance either, point the instance attributes at each command's poses.
+    for (size_t i = first; i < first + count; ++i)
+    {
+      const DrawElementsIndirectCommand &command = draw_commands_[i];
+
+      bind_instance_attributes(offset + command.base_instance * sizeof(InstancePose));
+      glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                        (GLsizei)command.count,
+                                        GL_UNSIGNED_INT,
+                                        reinterpret_cast<void *>(command.first_index * sizeof(GLuint)),
+                                        (GLsizei)command.instance_count,
+                                        command.base_vertex);
+    }
+  }
+
+  instance_stream_->fence();
+
+  if (indirect_stream_)
+  {
+    indirect_stream_->fence();
+  }
 }
 
-void BadEngine::draw_lines_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans)
+void BadEngine::update_frame_uniforms(const glm::mat4 &view_trans, const glm::mat4 &projection_trans)
 {
-  glLineWidth(3.f);
+  FrameUniforms *frame = static_cast<FrameUniforms *>(frame_stream_->begin(sizeof(FrameUniforms)));
 
-  line_shader_programme_.use();
-  glBindVertexArray(line_vao_);
+  frame->view = view_trans;
+  frame->projection = projection_trans;
+  frame->eye_pos = glm::vec4(cam_->get_pos(), 1.f);
+  frame->light_pos = glm::vec4(LIGHT_POS, 1.f);
 
-  line_shader_programme_.set_mat4("view", view_trans);
-  line_shader_programme_.set_mat4("projection", projection_trans);
-  line_shader_programme_.set_vec3("eye_pos", cam_->get_pos());
-
-  for (Line *line : lines_)
+  for (const auto &it : render_data_)
   {
-    glm::vec3 v2 = line->end - line->start;
-    glm::vec3 v2n = glm::normalize(v2);
-    glm::vec3 v1 = glm::normalize(glm::vec3(1.f, 1.f, 1.f) - glm::vec3(0.f, 0.f, 0.f));
-    float v2_length = glm::l2Norm(v2);
+    frame->material_colors[(size_t)it.first] = glm::vec4(it.second.object_color, 1.f);
+  }
 
-    glm::mat4 model_trans(1.f);
-    float theta = acos(dot(v1, v2n));
-    glm::vec3 axis = glm::normalize(glm::cross(v1, v2n));
+  size_t offset = frame_stream_->end();
 
-    model_trans = glm::translate(model_trans,
-                                 glm::vec3(line->start));
-    model_trans = glm::rotate(model_trans, theta, axis);
-    model_trans = glm::scale(model_trans, glm::vec3(v2_length));
+  glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, frame_stream_->id(), offset, sizeof(FrameUniforms));
+}
 
-    line_shader_programme_.set_mat4("model", model_trans);
-    line_shader_programme_.set_vec3("object_color", line->color);
+void BadEngine::draw_lines_program()
+{
+  PROFILE_SCOPE("lines");
+  PROFILE_GPU_SCOPE("lines");
 
-    glDrawArrays(GL_LINES, 0, (GLsizei)6);
+  for (const Line *line : lines_)
+  {
+    line_batch_->add(line->start, line->end, line->color);
   }
 
-  glLineWidth(1.f);
+  // together with this frame's DebugLines.
+  line_batch_->draw(3.f);
 }
 
-void BadEngine::draw_cube_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans)
+void BadEngine::draw_cube_program()
 {
+  PROFILE_GPU_SCOPE("cube");
+
   cube_shader_programme_.use();
   glBindVertexArray(cube_vao_[0]);
 
-  cube_shader_programme_.set_mat4("view", view_trans);
-  cube_shader_programme_.set_mat4("projection", projection_trans);
   glm::mat4 model_trans(1.f);
   model_trans = glm::translate(model_trans,
                                glm::vec3(cube_.pos.x,
                                          cube_.pos.y,
                                          cube_.pos.z));
   model_trans = glm::scale(model_trans, cube_scale_);
-  cube_shader_programme_.set_mat4("model", model_trans);
+  cube_shader_programme_.set_mat4(cube_model_location_, model_trans);
 
   glDrawElements(GL_LINE_STRIP,
                  sizeof(normalized_cube_indices) / sizeof(normalized_cube_indices[0]),
@@ -439,33 +680,59 @@ void BadEngine::draw_cube_program(const glm::mat4 &view_trans, const glm::mat4 &
 
 void BadEngine::draw()
 {
+  draw_frame();
+  frames_drawn_++;
+
+  // after the frame's draw scope closed, so it's counted in this frame.
+  PROFILE_END_FRAME();
+}
+
+void BadEngine::draw_frame()
+{
+  PROFILE_SCOPE("draw");
+
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
   glm::mat4 view_trans = cam_->get_view();
   glm::mat4 projection_trans = cam_->get_projection();
 
-  draw_shape_program(view_trans, projection_trans);
+  update_frame_uniforms(view_trans, projection_trans);
 
-  draw_cube_program(view_trans, projection_trans);
+  draw_shape_program(view_trans, projection_trans);
 
-  draw_lines_program(view_trans, projection_trans);
+  draw_cube_program();
 
-  glfwSwapBuffers(window_);
-  glfwPollEvents();
+  draw_lines_program();
 
-  cam_->update_time_deltas();
-  process_input();
+  frame_stream_->fence();
 
-#if COPY_WINDOW
+  if (capture_)
+  {
+    glReadBuffer(offscreen_ ? GL_COLOR_ATTACHMENT0 : GL_BACK);
+    capture_->capture();
 
-  GLsizei buffer_size = screen_width_ * screen_height_ * 3;
-  char *buffer = (char *)malloc(buffer_size);
+    if (capture_->has_failed())
+    {
+      stop_capture();
+    }
+  }
 
-  glReadPixels(0, 0, screen_width_, screen_height_, GL_RGB, GL_UNSIGNED_BYTE, (GLvoid *)buffer);
+#ifdef BE_PROFILE
+  if (show_profiler_)
+  {
+    profiler_overlay_->draw(Profiler::get().get_stats(), Profiler::get().get_frame_times());
+  }
+#endif
 
-  file_copier_.Push(buffer, buffer_size);
+  if (window_)
+  {
+    PROFILE_SCOPE("swap");
+    glfwSwapBuffers(window_);
+    glfwPollEvents();
+  }
 
-#endif
+  cam_->update_time_deltas();
+  process_input();
 }
 
 void BadEngine::key_callback(GLFWwindow *window, int key, int scancode, int action, int mods)
@@ -480,11 +747,117 @@ void BadEngine::key_callback(GLFWwindow *window, int key, int scancode, int acti
     glfwSetWindowShouldClose(window, GL_TRUE);
   }
   break;
+  case GLFW_KEY_F12:
+  {
+    if (action == GLFW_PRESS)
+    {
+      if (me->is_capturing())
+      {
+        me->stop_capture();
+      }
+      else
+      {
+        // don't throw through glfw, e.g. when the output can't be opened.
+        try
+        {
+          me->start_capture(me->capture_config_);
+        }
+        catch (const std::exception &error)
+        {
+          utility::dbg_print(error.what());
+        }
+      }
+    }
+  }
+  break;
+#ifdef BE_PROFILE
+  case GLFW_KEY_F10:
+  {
+    if (action == GLFW_PRESS)
+    {
+      static const char *TRACE_PATH = "trace.json";
+
+      if (Profiler::get().is_tracing())
+      {
+        Profiler::get().stop_trace();
+        utility::dbg_print(std::string("Trace written to ") + TRACE_PATH + ".");
+      }
+      else
+      {
+        // don't throw through glfw.
+        try
+        {
+          Profiler::get().start_trace(TRACE_PATH);
+        }
+        catch (const std::exception &error)
+        {
+          utility::dbg_print(error.what());
+        }
+      }
+    }
+  }
+  break;
+  case GLFW_KEY_F11:
+  {
+    if (action == GLFW_PRESS)
+    {
+      me->show_profiler_ = !me->show_profiler_;
+    }
+  }
+  break;
+#endif
   default:
     me->logic_key_handler_cb_(key, scancode, action, mods);
   }
 }
 
+void BadEngine::set_render_mode(RenderableType type, RenderMode mode)
+{
+  if (mode == RenderMode::impostor && type != RenderableType::sphere)
+  {
+    throw std::runtime_error("Impostors are only supported for spheres.");
+  }
+
+  render_modes_[type] = mode;
+}
+
+BadEngine::RenderMode BadEngine::get_render_mode(RenderableType type) const
+{
+  auto it = render_modes_.find(type);
+
+  return (it == render_modes_.end()) ? RenderMode::mesh : it->second;
+}
+
+void BadEngine::read_pixels(std::vector<unsigned char> &rgb) const
+{
+  rgb.resize((size_t)screen_width_ * screen_height_ * 3);
+
+  // a window's frame is in the front buffer once draw() swapped, the fbo keeps it anyway.
+  glReadBuffer(offscreen_ ? GL_COLOR_ATTACHMENT0 : GL_FRONT);
+  glReadPixels(0, 0, screen_width_, screen_height_, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+}
+
+void BadEngine::start_capture(const FrameCapture::Config &config)
+{
+  // flush the previous recording before reusing its output.
+  capture_.reset();
+  capture_config_ = config;
+  capture_ = std::make_unique<FrameCapture>(screen_width_, screen_height_, config);
+}
+
+void BadEngine::stop_capture()
+{
+  if (capture_)
+  {
+    capture_->finish();
+
+    std::stringstream inf;
+    inf << "Captured " << capture_->get_written_count() << " frames, dropped " << capture_->get_dropped_count() << "." << std::endl;
+    utility::dbg_print(inf.str());
+    capture_.reset();
+  }
+}
+
 void BadEngine::set_world_dims(glm::vec3 dims)
 {
   cube_scale_ = dims;
@@ -497,14 +870,15 @@ BadEngine::operator bool() const
 
 bool BadEngine::loop_done() const
 {
-  return !this || glfwWindowShouldClose(window_);
+  if (!this || (frame_limit_ > 0 && frames_drawn_ >= frame_limit_))
+    return true;
+
+  // nothing closes an offscreen context, a loop without a frame limit would never end.
+  return window_ ? glfwWindowShouldClose(window_) : frame_limit_ == 0;
 }
 
 void BadEngine::run()
 {
-  render_data_.at(RenderableType::sphere).program.use();
-  glBindVertexArray(render_data_.at(RenderableType::sphere).vao);
-
   while (!loop_done())
   {
     draw();
@@ -537,41 +911,19 @@ void BadEngine::demo_add_spheres()
   add_sphere(-1.f, 2.f, -.8f, false, false);
 }
 
-glm::mat4 &BadEngine::get_model(RenderableType type, size_t idx)
-{
-  return models_by_vao_.at(type).at(idx);
-}
-
 Renderable BadEngine::add_renderable(RenderableType type)
 {
-  models_by_vao_[type].push_back(glm::mat4{});
-  Accessor<glm::mat4> model_acc(std::bind(&BadEngine::get_model, this, type, models_by_vao_[type].size() - 1));
-  return Renderable(model_acc);
-}
-
-size_t BadEngine::add_state(const glm::vec3 &pos, const glm::vec3 &vel)
-{
-  states_.emplace_back(pos, vel);
-  return states_.size() - 1;
-}
-
-Accessor<State> BadEngine::get_state_acc(size_t idx)
-{
-  std::function<State &()> get_func(std::bind(&BadEngine::get_state, this, idx));
-  return Accessor<State>(get_func);
-}
+  std::vector<InstancePose> &poses = poses_by_vao_[type];
+  poses.push_back(InstancePose{ glm::vec3(0.f), glm::identity<glm::quat>(), glm::vec3(1.f), (GLuint)type });
 
-State &BadEngine::get_state(size_t idx)
-{
-  return states_.at(idx);
+  // unordered_map never moves its values, so the pointer stays valid.
+  return Renderable(&poses, poses.size() - 1);
 }
 
 size_t BadEngine::add_sphere(float x, float y, float z, bool is_static, bool renderable)
 {
   static constexpr float SPHERE_MASS = 7.f;
-  size_t idx = add_state(glm::vec3(x, y, z), glm::vec3{});
-
-  Sphere *sphere = new Sphere(x, y, z, sphere_rad_, get_state_acc(idx));
+  Sphere *sphere = sphere_pool_.create(world_, x, y, z, sphere_rad_);
 
   spheres_.push_back(sphere);
 
@@ -609,8 +961,7 @@ void BadEngine::set_sphere_velocity(int id, float x, float y, float z)
 size_t BadEngine::add_box(const glm::vec3 &center, const glm::vec3 &dims, bool is_static, bool renderable)
 {
   static constexpr float BOX_MASS = 7.f;
-  size_t idx = add_state(center, glm::vec3{});
-  Box *box = new Box(get_state_acc(idx), center, dims);
+  Box *box = box_pool_.create(world_, center, dims);
   boxes_.push_back(box);
   box->add_collidable(is_static ? -1.f : BOX_MASS);
 
@@ -625,7 +976,7 @@ size_t BadEngine::add_box(const glm::vec3 &center, const glm::vec3 &dims, bool i
 
 size_t BadEngine::add_line(const glm::vec3 &start, const glm::vec3 &end)
 {
-  lines_.push_back(new Line(start, end));
+  lines_.push_back(line_pool_.create(start, end));
   return lines_.size() - 1;
 }
 
@@ -636,8 +987,7 @@ Line *BadEngine::get_line(size_t id) const
 
 size_t BadEngine::add_arrow(const glm::vec3 &pos, const glm::vec3 &dims, bool renderable)
 {
-  size_t idx = add_state(pos, glm::vec3{});
-  arrows_.push_back(new Arrow(get_state_acc(idx), pos, dims));
+  arrows_.push_back(arrow_pool_.create(world_, pos, dims));
 
   if (renderable)
   {
@@ -3,15 +3,24 @@
 #include <string>
 #include "Camera.h"
 #include "const.h"
-#include "FileCopier.h"
-#include "OBJParser.h"
 #include "Shader.h"
+#include "ShaderRegistry.h"
 #include "Sphere.h"
 #include "Box.h"
 #include "Arrow.h"
 #include "Line.h"
-#include "State.h"
+#include "LineBatch.h"
+#include "World.h"
+#include "StreamBuffer.h"
+#include "InstanceCuller.h"
+#include "GeometryBuffer.h"
+#include "OffscreenContext.h"
+#include "FrameCapture.h"
+#include "ProfilerOverlay.h"
+#include "ObjectPool.h"
+#include <array>
 #include <functional>
+#include <memory>
 
 
 struct SimpleBox
@@ -27,13 +36,26 @@ public:
   ~BadEngine();
 
 public:
-  void init();
+  // where frames go, offscreen needs no display, e.g. EGL with Mesa's software rasteriser.
+  enum class Backend
+  {
+    window = 0,
+    offscreen,
+  };
+
+public:
+  void init(Backend backend = Backend::window);
   void run();
+  // draws and presents a frame, and closes the profiler's frame.
   void draw();
+  // true once the window asks to close or the frame limit is drawn. offscreen, only the
+  // frame limit ends the loop, without one it's done right away.
   bool loop_done() const;
+  // loop_done() after frames more draw() calls, 0 for no limit.
+  void set_frame_limit(size_t frames) { frame_limit_ = frames ? frames_drawn_ + frames : 0; }
   operator bool() const;
 
-private: // inner classes and enums
+public: // inner classes and enums
   enum class RenderableType
   {
     sphere = 0,
@@ -41,21 +63,97 @@ private: // inner classes and enums
     box,
   };
 
+  enum class RenderMode
+  {
+    mesh = 0,
+    // camera facing quads, ray-cast in the fragment shader. spheres only.
+    impostor,
+  };
+
+  // how sphere meshes are generated, see set_sphere_mesh().
+  enum class SphereMesh
+  {
+    icosphere = 0,
+    uv_sphere,
+    // a unit sphere from an obj, through its .bmesh cache, a single lod.
+    obj,
+  };
+
+private:
+  // shape programs, all types of a variant are drawn by one multi-draw.
+  enum class ShapeVariant
+  {
+    general = 0,
+    uniform_scale,
+    impostor,
+    count,
+  };
+
   struct RenderData
   {
-    GLuint vao;
-    size_t indices_count;
-    Shader program;
-    bool has_element_array;
+    std::vector<GeometryBuffer::MeshRange> lods; // finest first
+    ShapeVariant variant;
     glm::vec3 object_color;
+    float bounding_radius; // of the unscaled mesh
+    // see InstanceCuller::classify(), one less than lods.
+    std::vector<float> lod_min_pixels;
+  };
+
+  // layout of glMultiDrawElementsIndirect's commands.
+  struct DrawElementsIndirectCommand
+  {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+  };
+
+  // materials are indexed by RenderableType, see InstancePose::material.
+  static inline constexpr size_t MAX_MATERIALS = 8;
+
+  // std140 layout of the Frame block, see frame_uniforms.glsl.
+  struct FrameUniforms
+  {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 eye_pos;
+    glm::vec4 light_pos;
+    glm::vec4 material_colors[MAX_MATERIALS];
   };
 
 public:
   int get_status() const { return status_; }
+  void set_render_mode(RenderableType type, RenderMode mode);
+  RenderMode get_render_mode(RenderableType type) const;
   std::string get_message() const { return msg_; }
+  // the last frame drawn, rows bottom to top.
+  void read_pixels(std::vector<unsigned char> &rgb) const;
+  GLuint get_width() const { return screen_width_; }
+  GLuint get_height() const { return screen_height_; }
+  // records every drawn frame until stop_capture(), F12 toggles it with the last config.
+  void start_capture(const FrameCapture::Config &config);
+  void stop_capture();
+  bool is_capturing() const { return capture_ != nullptr; }
 
 public:
   Sphere *get_sphere(size_t id) const;
+  /**
+   * The sphere mesh of the finest lod, before init(). detail is an icosphere's subdivisions or
+   * a uv sphere's segments, with half as many rings. Each coarser lod has one subdivision
+   * less or half the segments.
+   */
+  void set_sphere_mesh(SphereMesh mesh, unsigned int detail)
+  {
+    sphere_mesh_ = mesh;
+    sphere_mesh_detail_ = detail;
+  }
+  // before init(), which throws if the obj can't be loaded, see BinaryMesh.
+  void set_sphere_mesh(const std::string &obj_path)
+  {
+    sphere_mesh_ = SphereMesh::obj;
+    sphere_mesh_path_ = obj_path;
+  }
   void set_sphere_radius(float rad) { sphere_rad_ = rad; }
   float get_sphere_radius(float rad) const { return sphere_rad_; }
   void set_sphere_pos(int id, float x, float y, float z);
@@ -71,41 +169,73 @@ public:
   Line *get_line(size_t id) const;
   size_t add_arrow(const glm::vec3 &pos, const glm::vec3 &dims, bool renderable);
   Arrow *get_arrow(size_t id) const;
+  World &get_world() { return world_; }
 
 private:
+  void init_window();
   void demo_add_spheres();
   void process_input();
   void draw_shape_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans);
   void init_sphere_program();
+  void init_sphere_mesh_from_obj();
   void init_boxes_program();
   void init_cube_program();
-  void draw_cube_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans);
+  void draw_cube_program();
   void init_lines_program();
-  void draw_lines_program(const glm::mat4 &view_trans, const glm::mat4 &projection_trans);
+  void draw_lines_program();
+  void init_profiler_overlay();
+  void draw_frame();
   void init_arrows_program();
-  glm::mat4 &get_model(RenderableType type, size_t idx);
+  void init_impostor_program();
+  void init_shape_programs();
+  ShapeVariant get_variant(RenderableType type) const;
+  void init_instance_attributes();
+  void bind_instance_attributes(size_t offset);
+  void update_frame_uniforms(const glm::mat4 &view_trans, const glm::mat4 &projection_trans);
+  void init_program(Shader &program);
   Renderable add_renderable(RenderableType type);
-  State &get_state(size_t idx);
-  Accessor<State> get_state_acc(size_t idx);
 
 private:
   static void key_callback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
 private:
-  GLFWwindow *window_;
+  GLFWwindow *window_ = nullptr;
+  // declared first, so the context outlives the gl objects of the members below.
+  std::unique_ptr<OffscreenContext> offscreen_;
   int status_;
   std::string msg_;
   Camera *cam_;
+  // all programs, declared before their users.
+  std::unique_ptr<ShaderRegistry> shaders_;
 
-  OBJParser parser_;
   std::unordered_map<RenderableType, RenderData> render_data_;
+  SphereMesh sphere_mesh_ = SphereMesh::icosphere;
+  unsigned int sphere_mesh_detail_ = 4;
+  std::string sphere_mesh_path_;
 
-  // (RenderableType --> vector of model transformations)
-  std::unordered_map<RenderableType, std::vector<glm::mat4>> models_by_vao_;
+  // (RenderableType --> vector of instance poses)
+  std::unordered_map<RenderableType, std::vector<InstancePose>> poses_by_vao_;
+  // per-frame poses of all types, read by the instanced draws.
+  std::unique_ptr<StreamBuffer> instance_stream_;
+  std::unordered_map<RenderableType, RenderMode> render_modes_;
+  std::unordered_map<RenderableType, InstanceCuller> cullers_;
+  std::unique_ptr<GeometryBuffer> geometry_;
+  GeometryBuffer::MeshRange impostor_quad_;
+  std::array<Shader, (size_t)ShapeVariant::count> shape_programs_;
+  // this frame's draws, grouped by variant.
+  std::vector<DrawElementsIndirectCommand> draw_commands_;
+  std::unique_ptr<StreamBuffer> indirect_stream_;
+  // view, projection and lighting, written once per frame and shared by all programs.
+  std::unique_ptr<StreamBuffer> frame_stream_;
 
 
-  std::vector<State> states_;
-  size_t add_state(const glm::vec3 &pos, const glm::vec3 &vel);
+  // components of all shapes, declared before the pools so it outlives them.
+  World world_;
+  // own the shapes, the vectors below index them by id.
+  ObjectPool<Sphere> sphere_pool_;
+  ObjectPool<Box> box_pool_;
+  ObjectPool<Line> line_pool_;
+  ObjectPool<Arrow> arrow_pool_;
 
   std::vector<Sphere *> spheres_;
   float sphere_rad_;
@@ -113,12 +243,12 @@ private:
   std::vector<Shape *> shapes_;
   std::vector<Box *> boxes_;
   std::vector<Line *> lines_;
-  Shader line_shader_programme_;
-  GLuint line_vao_ = 0;
+  std::unique_ptr<LineBatch> line_batch_;
 
   std::vector<Arrow *> arrows_;
 
   Shader cube_shader_programme_;
+  GLint cube_model_location_ = -1;
   GLuint cube_vbos_[2];
   GLuint cube_vao_[1];
   glm::vec3 cube_scale_;
@@ -126,5 +256,11 @@ private:
   std::function<void(int, int, int, int)> logic_key_handler_cb_;
   const GLuint screen_width_ = 1920;
   const GLuint screen_height_ = 1080;
-  FileCopier file_copier_;
+  FrameCapture::Config capture_config_;
+  std::unique_ptr<FrameCapture> capture_;
+  // F11 toggles it and F10 a trace to trace.json, only with BE_PROFILE.
+  std::unique_ptr<ProfilerOverlay> profiler_overlay_;
+  bool show_profiler_ = false;
+  size_t frames_drawn_ = 0;
+  size_t frame_limit_ = 0;
 };
@@ -0,0 +1,211 @@
+#include "BinaryMesh.h"
+#include "OBJParser.h"
+#include "utils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+
+namespace
+{
+  constexpr char MAGIC[4] = { 'B', 'M', 'S', 'H' };
+  constexpr uint32_t VERSION = 2;
+  constexpr uint64_t ALIGNMENT = 64;
+
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    // the obj's, the cache's key.
+    uint64_t source_hash;
+    int64_t source_mtime;
+    uint64_t source_size;
+    uint32_t vertex_size; // floats
+    uint32_t vertices_n;
+    uint32_t indices_n;
+    uint32_t reserved;
+    uint64_t vertices_offset;
+    uint64_t indices_offset;
+  };
+
+  static_assert(sizeof(Header) == ALIGNMENT, "the vertices start right after the header");
+
+  uint64_t align(uint64_t offset)
+  {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  }
+
+  // read only when the mtime changed.
+  uint64_t hash_file(const std::string &path)
+  {
+    MappedFile file(path);
+    return utility::hash(file.data(), file.size());
+  }
+
+  struct Source
+  {
+    bool exists;
+    uint64_t size;
+    int64_t mtime;
+  };
+
+  Source get_source(const std::string &path)
+  {
+    std::error_code ec;
+    const uint64_t size = std::filesystem::file_size(path, ec);
+    if (ec)
+      return Source{ false, 0, 0 };
+
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    return Source{ !ec, size, ec ? 0 : (int64_t)mtime.time_since_epoch().count() };
+  }
+
+  bool read_header(const std::string &cache_path, Header &header)
+  {
+    std::ifstream in(cache_path, std::ios::binary);
+    return in.read((char *)&header, sizeof(header)) && memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+           header.version == VERSION && header.vertex_size == BinaryMesh::VERTEX_SIZE;
+  }
+
+  // a touched but unchanged obj, e.g. after a checkout, skips the hash next time.
+  void update_mtime(const std::string &cache_path, Header header, int64_t mtime)
+  {
+    header.source_mtime = mtime;
+    std::fstream out(cache_path, std::ios::binary | std::ios::in | std::ios::out);
+    out.write((const char *)&header, sizeof(header));
+  }
+
+  bool is_fresh(const std::string &obj_path, const std::string &cache_path)
+  {
+    Header header;
+    if (!read_header(cache_path, header))
+      return false;
+
+    const Source source = get_source(obj_path);
+    if (!source.exists)
+      return true;
+    if (source.size != header.source_size)
+      return false;
+    if (source.mtime == header.source_mtime)
+      return true;
+    if (hash_file(obj_path) != header.source_hash)
+      return false;
+
+    update_mtime(cache_path, header, source.mtime);
+    return true;
+  }
+
+  void write_padding(std::ofstream &out, uint64_t to)
+  {
+    static constexpr char zeros[ALIGNMENT] = {};
+    out.write(zeros, to - (uint64_t)out.tellp());
+  }
+
+  // through a temporary, so a failed write never leaves a truncated cache behind.
+  bool write_cache(const std::string &cache_path, const Header &header,
+                   const std::vector<float> &vertices, const std::vector<unsigned int> &indices)
+  {
+    const std::string tmp_path = cache_path + ".tmp";
+    {
+      std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+      out.write((const char *)&header, sizeof(header));
+      write_padding(out, header.vertices_offset);
+      out.write((const char *)vertices.data(), vertices.size() * sizeof(float));
+      write_padding(out, header.indices_offset);
+      out.write((const char *)indices.data(), indices.size() * sizeof(unsigned int));
+
+      if (!out)
+        return false;
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, cache_path, ec);
+    if (ec)
+      std::filesystem::remove(tmp_path, ec);
+
+    return !ec;
+  }
+}
+
+BinaryMesh::BinaryMesh(const std::string &obj_path)
+{
+  const std::string cache_path = get_cache_path(obj_path);
+
+  if (is_fresh(obj_path, cache_path) && map_cache(cache_path))
+  {
+    cached_ = true;
+    return;
+  }
+
+  generate(obj_path, cache_path);
+}
+
+bool BinaryMesh::map_cache(const std::string &cache_path)
+{
+  auto file = std::make_unique<MappedFile>(cache_path);
+  if (!file->is_open() || file->size() < sizeof(Header))
+    return false;
+
+  Header header;
+  memcpy(&header, file->data(), sizeof(header));
+
+  const uint64_t vertices_bytes = (uint64_t)header.vertices_n * VERTEX_SIZE * sizeof(float);
+  const uint64_t indices_bytes = (uint64_t)header.indices_n * sizeof(unsigned int);
+  if (header.vertices_offset % ALIGNMENT || header.indices_offset % ALIGNMENT ||
+      header.vertices_offset + vertices_bytes > file->size() || header.indices_offset + indices_bytes > file->size())
+  {
+    return false;
+  }
+
+  vertices_ = (const float *)(file->data() + header.vertices_offset);
+  vertices_n_ = header.vertices_n;
+  indices_ = (const unsigned int *)(file->data() + header.indices_offset);
+  indices_n_ = header.indices_n;
+  file_ = std::move(file);
+
+  return true;
+}
+
+void BinaryMesh::generate(const std::string &obj_path, const std::string &cache_path)
+{
+  OBJParser parser;
+  if (!parser.parse(obj_path) && parser.get_indices().empty())
+  {
+    throw std::runtime_error("BinaryMesh: can't parse " + obj_path);
+  }
+
+  utility::dbg_print(obj_path + ": acmr " + std::to_string(parser.get_acmr_before()) + " -> " + std::to_string(parser.get_acmr_after()));
+
+  static_assert(OBJParser::VERTEX_SIZE == VERTEX_SIZE, "the parser's vertices are stored as is");
+  own_vertices_ = parser.get_data();
+  own_indices_ = parser.get_indices();
+  const size_t vertices_n = own_vertices_.size() / VERTEX_SIZE;
+
+  const Source source = get_source(obj_path);
+  Header header{};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.source_hash = hash_file(obj_path);
+  header.source_mtime = source.mtime;
+  header.source_size = source.size;
+  header.vertex_size = (uint32_t)VERTEX_SIZE;
+  header.vertices_n = (uint32_t)vertices_n;
+  header.indices_n = (uint32_t)own_indices_.size();
+  header.vertices_offset = sizeof(Header);
+  header.indices_offset = align(header.vertices_offset + own_vertices_.size() * sizeof(float));
+
+  // served from the mapping like a cache hit, the parsed copies are dropped.
+  if (write_cache(cache_path, header, own_vertices_, own_indices_) && map_cache(cache_path))
+  {
+    own_vertices_ = {};
+    own_indices_ = {};
+    return;
+  }
+
+  vertices_ = own_vertices_.data();
+  vertices_n_ = vertices_n;
+  indices_ = own_indices_.data();
+  indices_n_ = own_indices_.size();
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * An obj's mesh in the .bmesh format: a header, the interleaved vertices and the indices,
+ * each blob 64 byte aligned, so the mapped file is read in place. The cache sits next to
+ * the obj, it's written on first load and reused while the obj's mtime, or failing that
+ * its content hash, matches. Without the obj an existing cache is used as is.
+ */
+class BinaryMesh
+{
+public:
+  // pos.xyz, normal.xyz, uv, like GeometryBuffer and OBJParser::get_data().
+  static inline constexpr size_t VERTEX_SIZE = 8;
+
+public:
+  // throws std::runtime_error if there's no usable cache and the obj can't be parsed.
+  explicit BinaryMesh(const std::string &obj_path);
+  BinaryMesh(const BinaryMesh &) = delete;
+  BinaryMesh &operator=(const BinaryMesh &) = delete;
+
+public:
+  static std::string get_cache_path(const std::string &obj_path) { return obj_path + ".bmesh"; }
+
+  // VERTEX_SIZE floats each, physics consumers read the positions at that stride.
+  const float *get_vertices() const { return vertices_; }
+  size_t get_vertices_n() const { return vertices_n_; }
+  const unsigned int *get_indices() const { return indices_; }
+  size_t get_indices_n() const { return indices_n_; }
+  // false if the mesh was parsed from the obj on this load.
+  bool is_cached() const { return cached_; }
+
+private:
+  bool map_cache(const std::string &cache_path);
+  void generate(const std::string &obj_path, const std::string &cache_path);
+
+private:
+  std::unique_ptr<MappedFile> file_;
+  // only when the cache couldn't be written and mapped.
+  std::vector<float> own_vertices_;
+  std::vector<unsigned int> own_indices_;
+
+  const float *vertices_ = nullptr;
+  size_t vertices_n_ = 0;
+  const unsigned int *indices_ = nullptr;
+  size_t indices_n_ = 0;
+  bool cached_ = false;
+};
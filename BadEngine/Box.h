@@ -2,41 +2,13 @@
 
 #include "gl_incs.h"
 #include "Shape.h"
-#include "State.h"
-
-#include <mutex>
-#include <unordered_set>
-#include "utils.h"
 
 class Box : public Shape
 {
 public:
-  Box(Accessor<State> state_acc,
+  Box(World &world,
       const glm::vec3 &center,
-      const glm::vec3 &dims) : Shape(state_acc, dims),
-                               color(1., .5, .71)
-  {
-    set_pos(center);
-    set_vel(glm::vec3(0.f));
-
-    float half_angle = 0.5f * (utility::PI * 0.f);
-
-    set_orientation(glm::normalize((glm::quat(cos(half_angle),
-                                              sin(half_angle) * 1.f,
-                                              sin(half_angle) * 0.f,
-                                              sin(half_angle) * 0.f))));
-  }
-
-  virtual Collidable create_collidable(float mass) const override
+      const glm::vec3 &dims) : Shape(world, Geometry::Type::box, center, dims)
   {
-    glm::mat3 IBody = glm::identity<glm::mat3>() * (mass / 12.f);
-    const glm::vec3 &dims = get_dims();
-    IBody[0][0] = dims.y * dims.y + dims.z * dims.z;
-    IBody[1][1] = dims.x * dims.x + dims.z * dims.z;
-    IBody[2][2] = dims.x * dims.x + dims.y * dims.y;
-
-    return Collidable(Collidable::Type::box, mass, IBody);
   }
-
-  glm::vec3 color;
 };
@@ -1,9 +1,12 @@
 #include "Camera.h"
+#include "utils.h"
 #include <iostream>
 
 using namespace std;
 
 Camera::Camera(GLFWwindow *window,
+               int screen_w,
+               int screen_h,
                const glm::vec3 &pos,
                const glm::vec3 &front,
                const glm::vec3 &world_up) :
@@ -18,7 +21,9 @@ Camera::Camera(GLFWwindow *window,
   zoom_speed_base_(1000.f),
   translation_speed_base_(5.f),
   spin_speed_base_(7.5f),
-  is_cursor_init_(false)
+  is_cursor_init_(false),
+  screen_w_(screen_w),
+  screen_h_(screen_h)
 {
   up_ = world_up_;
   front_ = orig_front_;
@@ -26,8 +31,6 @@ Camera::Camera(GLFWwindow *window,
   spin_speed_ = spin_speed_base_;
   zoom_speed_ = zoom_speed_base_;
   translation_speed_ = translation_speed_base_;
-
-  glfwGetWindowSize(window_, &screen_w_, &screen_h_);
 }
 
 
@@ -62,6 +65,9 @@ void Camera::increase_pos(const glm::vec3 &pos)
 
 void Camera::process_keyboard_input()
 {
+  if (!window_)
+    return;
+
   // Move forward/backward.
   if (int key_u = glfwGetKey(window_, GLFW_KEY_W),
       key_d = glfwGetKey(window_, GLFW_KEY_S);
@@ -132,13 +138,6 @@ glm::mat4 Camera::get_view() const
 
 glm::mat4 Camera::get_projection() const
 {
-  GLfloat p = (GLfloat)glfwGetTime();
-  float x = 0.f, z = 0.f;
-  static float radius = 10.f;
-
-  x = sin(p)*radius;
-  z = cos(p)*radius;
-
   glm::mat4 projection = glm::perspective(get_fov(),
                                           (float)screen_w_ / (float)screen_h_,
                                           .1f, 100.f);
@@ -234,7 +233,7 @@ void Camera::increase_yaw(float off)
 
 void Camera::update_time_deltas()
 {
-  GLfloat curr_time = (GLfloat)glfwGetTime();
+  GLfloat curr_time = (GLfloat)utility::get_time();
   delta_time_ = curr_time - last_frame_;
   last_frame_ = curr_time;
 
@@ -9,7 +9,10 @@
 class Camera
 {
 public:
+  // window may be null when rendering offscreen, input is ignored then.
   Camera(GLFWwindow *window,
+         int screen_w,
+         int screen_h,
          const glm::vec3 &pos,
          const glm::vec3 &front,
          const glm::vec3 &world_up);
@@ -1,8 +1,6 @@
 #pragma once
 
 #include "gl_incs.h"
-#include "Accessor.h"
-#include "State.h"
 
 struct Collidable
 {
@@ -20,7 +18,6 @@ struct Collidable
 
   float inv_mass;
   glm::mat3 IBodyInv = glm::mat3(0.f), IInv = glm::mat3(1.f);
-  float elasticity = .9f;
   glm::vec3 P;
   glm::vec3 L;
 
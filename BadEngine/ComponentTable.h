@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using Entity = uint32_t;
+
+/**
+ * Components of one type as a sparse set: the values lie densely in a vector, in no
+ * particular order, and a sparse vector indexed by entity finds them. Systems iterate
+ * get_data() and get_entities() side by side. remove() moves the last value into the
+ * hole, so pointers and references into the table don't survive adds or removes.
+ */
+template <class T>
+class ComponentTable
+{
+public:
+  static inline constexpr uint32_t NO_IDX = UINT32_MAX;
+
+public:
+  template <class... Args>
+  T &add(Entity entity, Args &&...args)
+  {
+    assert(!has(entity));
+
+    if (entity >= sparse_.size())
+      sparse_.resize(entity + 1, NO_IDX);
+
+    sparse_[entity] = (uint32_t)data_.size();
+    entities_.push_back(entity);
+    data_.push_back(T{ std::forward<Args>(args)... });
+
+    return data_.back();
+  }
+
+  void remove(Entity entity)
+  {
+    if (!has(entity))
+      return;
+
+    const uint32_t idx = sparse_[entity];
+    const Entity last = entities_.back();
+
+    data_[idx] = std::move(data_.back());
+    entities_[idx] = last;
+    sparse_[last] = idx;
+
+    data_.pop_back();
+    entities_.pop_back();
+    sparse_[entity] = NO_IDX;
+  }
+
+  bool has(Entity entity) const
+  {
+    return entity < sparse_.size() && sparse_[entity] != NO_IDX;
+  }
+
+  T &get(Entity entity)
+  {
+    assert(has(entity));
+    return data_[sparse_[entity]];
+  }
+
+  const T &get(Entity entity) const
+  {
+    assert(has(entity));
+    return data_[sparse_[entity]];
+  }
+
+  // nullptr if the entity has no such component.
+  T *find(Entity entity)
+  {
+    return has(entity) ? &data_[sparse_[entity]] : nullptr;
+  }
+
+  size_t size() const { return data_.size(); }
+  std::vector<T> &get_data() { return data_; }
+  const std::vector<T> &get_data() const { return data_; }
+  // the entity of each value, same order as get_data().
+  const std::vector<Entity> &get_entities() const { return entities_; }
+
+  void reserve(size_t n)
+  {
+    data_.reserve(n);
+    entities_.reserve(n);
+  }
+
+private:
+  std::vector<T> data_;
+  std::vector<Entity> entities_;
+  std::vector<uint32_t> sparse_; // entity --> index into data_
+};
@@ -0,0 +1,304 @@
+#include "FrameCapture.h"
+#include "utils.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#define PIPE_WRITE_MODE "wb"
+#else
+#define PIPE_WRITE_MODE "w"
+#endif
+
+// a readback is PBOS_N frames old when collected, this only guards against a hung gpu.
+static inline constexpr GLuint64 READBACK_TIMEOUT_NS = 1000000000;
+
+FrameCapture::FrameCapture(int width, int height, const Config &config) : width_(width),
+                                                                          height_(height),
+                                                                          config_(config),
+                                                                          frame_size_((size_t)width * height * 3),
+                                                                          pool_(config.pool_size, Frame(frame_size_)),
+                                                                          free_(config.pool_size),
+                                                                          filled_(config.pool_size)
+{
+  if (config_.format == Format::pipe)
+  {
+    if (config_.encoder_command.empty())
+    {
+      throw std::runtime_error("The pipe capture needs an encoder command.");
+    }
+
+#ifndef _WIN32
+    // an encoder that exits early would kill the process on the next write, fail the write with EPIPE instead.
+    std::signal(SIGPIPE, SIG_IGN);
+#endif
+    out_ = popen(config_.encoder_command.c_str(), PIPE_WRITE_MODE);
+  }
+  else
+  {
+    std::filesystem::create_directories(config_.output_dir);
+
+    if (config_.format == Format::y4m)
+    {
+      out_ = fopen((std::filesystem::path(config_.output_dir) / (config_.name + ".y4m")).string().c_str(), "wb");
+    }
+  }
+
+  if (config_.format != Format::raw)
+  {
+    if (!out_)
+    {
+      throw std::runtime_error("Cannot open the capture output.");
+    }
+
+    fprintf(out_, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C444\n", width_, height_, config_.fps);
+    yuv_.resize(frame_size_);
+  }
+
+  for (Frame &frame : pool_)
+  {
+    free_.try_push(&frame);
+  }
+
+  glGenBuffers(PBOS_N, pbos_);
+
+  for (GLuint pbo : pbos_)
+  {
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, frame_size_, NULL, GL_STREAM_READ);
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  writer_ = std::thread(&FrameCapture::writer_loop, this);
+}
+
+FrameCapture::~FrameCapture()
+{
+  finish();
+}
+
+void FrameCapture::finish()
+{
+  if (finished_)
+  {
+    return;
+  }
+
+  finished_ = true;
+
+  // the readbacks still in flight, in order.
+  for (size_t i = (frames_n_ > PBOS_N) ? frames_n_ - PBOS_N : 0; i < frames_n_; ++i)
+  {
+    collect(i % PBOS_N, true);
+  }
+
+  glDeleteBuffers(PBOS_N, pbos_);
+
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  frame_filled_cv_.notify_one();
+  writer_.join();
+
+  close_output();
+}
+
+void FrameCapture::close_output()
+{
+  if (out_)
+  {
+    if (config_.format == Format::pipe)
+    {
+      pclose(out_);
+    }
+    else
+    {
+      fclose(out_);
+    }
+
+    out_ = nullptr;
+  }
+}
+
+void FrameCapture::capture()
+{
+  if (finished_ || failed_.load(std::memory_order_relaxed))
+  {
+    return;
+  }
+
+  const size_t pbo = frames_n_ % PBOS_N;
+
+  if (frames_n_ >= PBOS_N)
+  {
+    collect(pbo, config_.overflow == OverflowPolicy::block);
+  }
+
+  // rows are tightly packed, no padding to 4 bytes.
+  glPixelStorei(GL_PACK_ALIGNMENT, 1);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[pbo]);
+  glReadPixels(0, 0, width_, height_, GL_RGB, GL_UNSIGNED_BYTE, NULL);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  fences_[pbo] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  ++frames_n_;
+}
+
+void FrameCapture::collect(size_t pbo, bool block)
+{
+  glClientWaitSync(fences_[pbo], GL_SYNC_FLUSH_COMMANDS_BIT, READBACK_TIMEOUT_NS);
+  glDeleteSync(fences_[pbo]);
+  fences_[pbo] = 0;
+
+  Frame *frame = acquire_frame(block);
+
+  if (!frame)
+  {
+    ++dropped_;
+    return;
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos_[pbo]);
+
+  if (const void *pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frame_size_, GL_MAP_READ_BIT))
+  {
+    std::memcpy(frame->data(), pixels, frame_size_);
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  // never full, the rings hold at most the whole pool.
+  filled_.try_push(frame);
+
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  frame_filled_cv_.notify_one();
+}
+
+FrameCapture::Frame *FrameCapture::acquire_frame(bool block)
+{
+  Frame *frame = nullptr;
+
+  if (free_.try_pop(frame) || !block)
+  {
+    return frame;
+  }
+
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  frame_freed_cv_.wait(lock, [&]
+                       { return free_.try_pop(frame); });
+
+  return frame;
+}
+
+void FrameCapture::writer_loop()
+{
+  Frame *frame = nullptr;
+
+  while (true)
+  {
+    if (filled_.try_pop(frame))
+    {
+      // after a failed write the frames in flight are only handed back.
+      if (!failed_.load(std::memory_order_relaxed))
+      {
+        if (write_frame(*frame))
+        {
+          written_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+          failed_.store(true, std::memory_order_relaxed);
+          close_output();
+        }
+      }
+      free_.try_push(frame);
+
+      {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+      }
+      frame_freed_cv_.notify_one();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+
+    if (stopping_ && filled_.empty())
+    {
+      break;
+    }
+
+    frame_filled_cv_.wait(lock, [&]
+                          { return !filled_.empty() || stopping_; });
+  }
+}
+
+bool FrameCapture::write_frame(const Frame &frame)
+{
+  if (config_.format != Format::raw)
+  {
+    return write_y4m_frame(frame);
+  }
+
+  char file_name[32];
+  snprintf(file_name, sizeof(file_name), "%05zu.raw", written_.load(std::memory_order_relaxed));
+
+  const std::filesystem::path path = std::filesystem::path(config_.output_dir) / (config_.name + file_name);
+
+  FILE *fd = fopen(path.string().c_str(), "wb");
+  bool ok = fd && fwrite(frame.data(), 1, frame.size(), fd) == frame.size();
+
+  if (fd && fclose(fd) != 0)
+  {
+    ok = false;
+  }
+
+  if (!ok)
+  {
+    utility::dbg_print("Cannot write " + path.string() + ", capture stopped.");
+  }
+
+  return ok;
+}
+
+bool FrameCapture::write_y4m_frame(const Frame &frame)
+{
+  // BT.601 studio range. gl's rows are bottom-up, y4m's top-down.
+  const size_t plane_size = (size_t)width_ * height_;
+  unsigned char *y_plane = yuv_.data();
+  unsigned char *u_plane = y_plane + plane_size;
+  unsigned char *v_plane = u_plane + plane_size;
+
+  for (int row = 0; row < height_; ++row)
+  {
+    const unsigned char *src = frame.data() + (size_t)(height_ - 1 - row) * width_ * 3;
+    const size_t dst = (size_t)row * width_;
+
+    for (int col = 0; col < width_; ++col, src += 3)
+    {
+      const int r = src[0], g = src[1], b = src[2];
+
+      y_plane[dst + col] = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+      u_plane[dst + col] = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+      v_plane[dst + col] = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+  }
+
+  if (fputs("FRAME\n", out_) < 0 || fwrite(yuv_.data(), 1, yuv_.size(), out_) != yuv_.size())
+  {
+    // EPIPE when the encoder exited.
+    utility::dbg_print(std::string("Cannot write a captured frame, capture stopped: ") + strerror(errno));
+    return false;
+  }
+
+  return true;
+}
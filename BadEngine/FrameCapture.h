@@ -0,0 +1,110 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Records the frames drawn to the current read buffer without stalling the render thread.
+ *
+ * capture() starts an asynchronous glReadPixels into one of PBOS_N pixel buffer objects
+ * and collects the readback started PBOS_N frames earlier, which the gpu has finished
+ * by then. Collected frames are copied into pooled buffers and handed to a writer
+ * thread through an SpscRing. When the writer falls behind and the pool is empty,
+ * frames are dropped or the render thread waits, per OverflowPolicy.
+ */
+class FrameCapture
+{
+public:
+  enum class Format
+  {
+    // a file of bottom-up rgb rows per frame, output_dir/name00000.raw.
+    raw = 0,
+    // one YUV4MPEG2 (4:4:4) stream, output_dir/name.y4m.
+    y4m,
+    // the y4m stream written to encoder_command's stdin, e.g.
+    // "ffmpeg -y -f yuv4mpegpipe -i - -pix_fmt yuv420p out.mp4".
+    pipe,
+  };
+
+  enum class OverflowPolicy
+  {
+    drop = 0,
+    block,
+  };
+
+  struct Config
+  {
+    Format format = Format::y4m;
+    std::string output_dir = ".";
+    std::string name = "capture";
+    std::string encoder_command;
+    OverflowPolicy overflow = OverflowPolicy::drop;
+    size_t pool_size = 8; // frames in flight between the render and the writer thread
+    unsigned int fps = 60;
+  };
+
+public:
+  // needs a current gl context. throws std::runtime_error if the output can't be opened or
+  // a pipe has no encoder command. ignores SIGPIPE for pipes, so a dead encoder fails the write.
+  FrameCapture(int width, int height, const Config &config);
+  ~FrameCapture();
+  FrameCapture(const FrameCapture &) = delete;
+  FrameCapture &operator=(const FrameCapture &) = delete;
+
+public:
+  // after drawing a frame, before swapping buffers.
+  void capture();
+  // writes all frames captured so far and closes the output, capture() is a no-op after.
+  void finish();
+  size_t get_dropped_count() const { return dropped_; }
+  size_t get_written_count() const { return written_.load(std::memory_order_relaxed); }
+  // a frame couldn't be written, the output is closed and capture() is a no-op.
+  bool has_failed() const { return failed_.load(std::memory_order_relaxed); }
+
+private:
+  using Frame = std::vector<unsigned char>;
+
+  void collect(size_t pbo, bool block);
+  // a pooled frame, nullptr if there's none and not blocking.
+  Frame *acquire_frame(bool block);
+  void writer_loop();
+  // false on a write error.
+  bool write_frame(const Frame &frame);
+  bool write_y4m_frame(const Frame &frame);
+  void close_output();
+
+private:
+  static inline constexpr size_t PBOS_N = 3;
+
+  const int width_, height_;
+  const Config config_;
+  const size_t frame_size_;
+
+  GLuint pbos_[PBOS_N] = { 0 };
+  GLsync fences_[PBOS_N] = { 0 };
+  size_t frames_n_ = 0; // readbacks started
+  bool finished_ = false;
+  size_t dropped_ = 0;
+
+  std::vector<Frame> pool_;
+  SpscRing<Frame *> free_;   // writer --> render thread
+  SpscRing<Frame *> filled_; // render --> writer thread
+  // only for sleeping while a ring is empty, the rings themselves are lock-free.
+  std::mutex wake_mutex_;
+  std::condition_variable frame_filled_cv_, frame_freed_cv_;
+  std::atomic<bool> stopping_{ false };
+  std::atomic<size_t> written_{ 0 };
+  std::atomic<bool> failed_{ false };
+
+  FILE *out_ = nullptr; // y4m file or encoder pipe, the writer thread closes it on a write error
+  std::vector<unsigned char> yuv_;
+  std::thread writer_;
+};
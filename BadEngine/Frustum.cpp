@@ -0,0 +1,32 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const glm::mat4 &view_projection)
+{
+  // Gribb & Hartmann: each plane is the 4th row of the matrix plus/minus another row.
+  const glm::mat4 m = glm::transpose(view_projection);
+
+  planes_[0] = m[3] + m[0];
+  planes_[1] = m[3] - m[0];
+  planes_[2] = m[3] + m[1];
+  planes_[3] = m[3] - m[1];
+  planes_[4] = m[3] + m[2];
+  planes_[5] = m[3] - m[2];
+
+  for (glm::vec4 &plane : planes_)
+  {
+    plane /= glm::length(glm::vec3(plane));
+  }
+}
+
+bool Frustum::intersects_sphere(const glm::vec3 &center, float radius) const
+{
+  for (const glm::vec4 &plane : planes_)
+  {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
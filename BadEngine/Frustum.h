@@ -0,0 +1,17 @@
+#pragma once
+
+#include "gl_incs.h"
+
+class Frustum
+{
+public:
+  // planes are extracted from projection * view, so they're in world space.
+  Frustum(const glm::mat4 &view_projection);
+
+public:
+  bool intersects_sphere(const glm::vec3 &center, float radius) const;
+
+private:
+  // (normal, d), normals point inside. left, right, bottom, top, near, far.
+  glm::vec4 planes_[6];
+};
@@ -0,0 +1,78 @@
+#include "GeometryBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GeometryBuffer::~GeometryBuffer()
+{
+  if (vao_)
+  {
+    glDeleteBuffers(sizeof(buffers_) / sizeof(buffers_[0]), buffers_);
+    glDeleteVertexArrays(1, &vao_);
+  }
+}
+
+GeometryBuffer::MeshRange GeometryBuffer::add_mesh(const float *vertices, size_t vertices_n, size_t stride,
+                                                   const unsigned int *indices, size_t indices_n)
+{
+  if (stride < 6)
+  {
+    throw std::runtime_error("GeometryBuffer: vertices need a position and a normal.");
+  }
+
+  MeshRange range{ static_cast<GLuint>(indices_.size()),
+                   static_cast<GLuint>(indices_n),
+                   static_cast<GLint>(vertices_.size() / VERTEX_SIZE) };
+
+  if (stride == VERTEX_SIZE)
+  {
+    // already in our layout, e.g. a mapped BinaryMesh.
+    vertices_.insert(vertices_.end(), vertices, vertices + vertices_n * VERTEX_SIZE);
+  }
+  else
+  {
+    const size_t copied = std::min(stride, VERTEX_SIZE);
+
+    for (size_t i = 0; i < vertices_n; ++i)
+    {
+      const float *vertex = vertices + i * stride;
+
+      vertices_.insert(vertices_.end(), vertex, vertex + copied);
+      vertices_.resize(vertices_.size() + VERTEX_SIZE - copied, 0.f);
+    }
+  }
+
+  indices_.insert(indices_.end(), indices, indices + indices_n);
+
+  return range;
+}
+
+void GeometryBuffer::upload()
+{
+  glGenVertexArrays(1, &vao_);
+  glBindVertexArray(vao_);
+
+  glGenBuffers(sizeof(buffers_) / sizeof(buffers_[0]), buffers_);
+  glBindBuffer(GL_ARRAY_BUFFER, buffers_[0]);
+  glBufferData(GL_ARRAY_BUFFER,
+               vertices_.size() * sizeof(vertices_[0]),
+               vertices_.data(),
+               GL_STATIC_DRAW);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers_[1]);
+  glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+               indices_.size() * sizeof(indices_[0]),
+               indices_.data(),
+               GL_STATIC_DRAW);
+
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat), reinterpret_cast<void *>(0));
+  glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat), reinterpret_cast<void *>(3 * sizeof(GLfloat)));
+  glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, VERTEX_SIZE * sizeof(GLfloat), reinterpret_cast<void *>(6 * sizeof(GLfloat)));
+
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+
+  // the gpu has its copy.
+  vertices_ = std::vector<float>();
+  indices_ = std::vector<unsigned int>();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "gl_incs.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * The static meshes of all shapes in one vertex and one index buffer, sharing one
+ * vertex format and one vao, so draws of different meshes differ only by their
+ * first index and base vertex, e.g. in a DrawElementsIndirectCommand.
+ *
+ * Meshes are added on the cpu, upload() creates the gl objects.
+ */
+class GeometryBuffer
+{
+public:
+  // pos.xyz, normal.xyz, uv
+  static inline constexpr size_t VERTEX_SIZE = 8;
+
+  struct MeshRange
+  {
+    GLuint first_index;
+    GLuint indices_count;
+    GLint base_vertex;
+  };
+
+public:
+  GeometryBuffer() = default;
+  ~GeometryBuffer();
+  GeometryBuffer(const GeometryBuffer &) = delete;
+  GeometryBuffer &operator=(const GeometryBuffer &) = delete;
+
+public:
+  /**
+   * stride - floats per vertex, starting with pos.xyz and normal.xyz. the uv is
+   *          copied when present, zeroed otherwise.
+   */
+  MeshRange add_mesh(const float *vertices, size_t vertices_n, size_t stride,
+                     const unsigned int *indices, size_t indices_n);
+  // leaves the vao bound, for the caller to add per-instance attributes.
+  void upload();
+
+  GLuint vao() const { return vao_; }
+
+private:
+  std::vector<float> vertices_;
+  std::vector<unsigned int> indices_;
+  GLuint vao_ = 0;
+  GLuint buffers_[2] = { 0 };
+};
@@ -0,0 +1,112 @@
+#include "InstanceCuller.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <stdexcept>
+
+InstanceCuller::View::View(const glm::mat4 &view,
+                           const glm::mat4 &projection,
+                           float viewport_height) : frustum(projection * view),
+                                                    view(view),
+                                                    pixels_per_unit(projection[1][1] * viewport_height * .5f)
+{
+}
+
+void InstanceCuller::classify(const std::vector<InstancePose> &poses,
+                              float bounding_radius,
+                              const View &view,
+                              const std::vector<float> &lod_min_pixels)
+{
+  if (lod_min_pixels.size() >= MAX_LODS)
+  {
+    throw std::runtime_error("Too many lods.");
+  }
+
+  const size_t chunks_n = (poses.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  lods_.resize(poses.size());
+  chunk_counts_.resize(chunks_n);
+  chunks_.resize(chunks_n);
+  std::iota(chunks_.begin(), chunks_.end(), 0);
+
+  std::for_each(std::execution::par, chunks_.begin(), chunks_.end(), [&](size_t chunk)
+                {
+                  std::array<size_t, MAX_LODS> &counts = chunk_counts_[chunk];
+                  counts.fill(0);
+
+                  const size_t end = std::min(poses.size(), (chunk + 1) * CHUNK_SIZE);
+
+                  for (size_t i = chunk * CHUNK_SIZE; i < end; ++i)
+                  {
+                    const InstancePose &pose = poses[i];
+                    const float radius = bounding_radius * std::max(pose.scale.x, std::max(pose.scale.y, pose.scale.z));
+
+                    if (!view.frustum.intersects_sphere(pose.pos, radius))
+                    {
+                      lods_[i] = CULLED;
+                      continue;
+                    }
+
+                    // distance along the view direction, the camera looks down -z.
+                    const float depth = std::max(-(view.view * glm::vec4(pose.pos, 1.f)).z, radius);
+                    const float pixels = radius * view.pixels_per_unit / depth;
+
+                    uint8_t lod = 0;
+                    while (lod < lod_min_pixels.size() && pixels < lod_min_pixels[lod])
+                    {
+                      ++lod;
+                    }
+
+                    lods_[i] = lod;
+                    counts[lod]++;
+                  }
+                });
+
+  lod_counts_.fill(0);
+  for (const std::array<size_t, MAX_LODS> &counts : chunk_counts_)
+  {
+    for (size_t lod = 0; lod < MAX_LODS; ++lod)
+    {
+      lod_counts_[lod] += counts[lod];
+    }
+  }
+
+  visible_count_ = std::accumulate(lod_counts_.begin(), lod_counts_.end(), size_t(0));
+}
+
+void InstanceCuller::write(const std::vector<InstancePose> &poses, InstancePose *dst)
+{
+  // where each chunk starts writing each lod, chunks keep their order within a lod.
+  chunk_offsets_.resize(chunk_counts_.size());
+  std::array<size_t, MAX_LODS> next = { 0 };
+
+  for (size_t lod = 1; lod < MAX_LODS; ++lod)
+  {
+    next[lod] = next[lod - 1] + lod_counts_[lod - 1];
+  }
+
+  for (size_t chunk = 0; chunk < chunk_counts_.size(); ++chunk)
+  {
+    chunk_offsets_[chunk] = next;
+
+    for (size_t lod = 0; lod < MAX_LODS; ++lod)
+    {
+      next[lod] += chunk_counts_[chunk][lod];
+    }
+  }
+
+  std::for_each(std::execution::par, chunks_.begin(), chunks_.end(), [&](size_t chunk)
+                {
+                  std::array<size_t, MAX_LODS> offsets = chunk_offsets_[chunk];
+                  const size_t end = std::min(poses.size(), (chunk + 1) * CHUNK_SIZE);
+
+                  for (size_t i = chunk * CHUNK_SIZE; i < end; ++i)
+                  {
+                    if (lods_[i] != CULLED)
+                    {
+                      dst[offsets[lods_[i]]++] = poses[i];
+                    }
+                  }
+                });
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Frustum.h"
+#include "Renderable.h"
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Culls a type's instances against the view frustum and sorts the survivors into
+ * level-of-detail buckets, in parallel over fixed size chunks.
+ *
+ * classify() decides each instance's bucket and counts, write() then copies the
+ * visible instances grouped by lod (lod 0 first) and in their original order, so
+ * the destination can be mapped gpu memory of exactly get_visible_count() poses.
+ */
+class InstanceCuller
+{
+public:
+  static inline constexpr size_t MAX_LODS = 4;
+
+  struct View
+  {
+    View(const glm::mat4 &view, const glm::mat4 &projection, float viewport_height);
+
+    Frustum frustum;
+    glm::mat4 view;
+    // projected radius in pixels of a unit radius sphere, one unit in front of the eye.
+    float pixels_per_unit;
+  };
+
+public:
+  /**
+   * bounding_radius - radius of the type's mesh before scaling.
+   * lod_min_pixels - minimal projected radius in pixels of every lod but the last.
+   *                  descending, the number of lods is lod_min_pixels.size() + 1.
+   */
+  void classify(const std::vector<InstancePose> &poses,
+                float bounding_radius,
+                const View &view,
+                const std::vector<float> &lod_min_pixels);
+  void write(const std::vector<InstancePose> &poses, InstancePose *dst);
+
+  size_t get_visible_count() const { return visible_count_; }
+  size_t get_lod_count(size_t lod) const { return lod_counts_[lod]; }
+
+private:
+  static inline constexpr uint8_t CULLED = 0xff;
+  static inline constexpr size_t CHUNK_SIZE = 4096;
+
+  std::vector<uint8_t> lods_; // per instance, lod index or CULLED
+  std::vector<std::array<size_t, MAX_LODS>> chunk_counts_;
+  std::vector<std::array<size_t, MAX_LODS>> chunk_offsets_;
+  std::vector<size_t> chunks_;
+  std::array<size_t, MAX_LODS> lod_counts_ = { 0 };
+  size_t visible_count_ = 0;
+};
@@ -0,0 +1,116 @@
+#include "LineBatch.h"
+
+#include <cstddef>
+#include <cstring>
+
+void DebugLines::add(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &color)
+{
+  if (!is_enabled())
+  {
+    return;
+  }
+
+  ThreadBuffer &buffer = get_thread_buffer();
+
+  if (buffer.vertices.size() >= MAX_THREAD_LINES * 2)
+  {
+    return;
+  }
+
+  buffer.vertices.push_back(LineVertex{ start, color });
+  buffer.vertices.push_back(LineVertex{ end, color });
+}
+
+void DebugLines::begin_step()
+{
+  std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+
+  for (const auto &buffer : registry_)
+  {
+    // keeps the capacity, steady state emits don't allocate.
+    buffer->vertices.clear();
+  }
+}
+
+void DebugLines::collect(std::vector<LineVertex> &dst)
+{
+  std::lock_guard<std::mutex> registry_lock(registry_mutex_);
+
+  for (const auto &buffer : registry_)
+  {
+    dst.insert(dst.end(), buffer->vertices.begin(), buffer->vertices.end());
+    buffer->vertices.clear();
+  }
+}
+
+DebugLines::ThreadBuffer &DebugLines::get_thread_buffer()
+{
+  thread_local std::shared_ptr<ThreadBuffer> buffer;
+
+  if (!buffer)
+  {
+    buffer = std::make_shared<ThreadBuffer>();
+
+    std::lock_guard<std::mutex> lock(registry_mutex_);
+    registry_.push_back(buffer);
+  }
+
+  return *buffer;
+}
+
+// vertex attribute locations, see line_vs.glsl.
+static constexpr GLuint POS_LOCATION = 0;
+static constexpr GLuint COLOR_LOCATION = 1;
+static constexpr size_t INITIAL_LINES_N = 4096;
+
+LineBatch::LineBatch(ShaderRegistry &shaders) : stream_(GL_ARRAY_BUFFER, INITIAL_LINES_N * 2 * sizeof(LineVertex)),
+                                                program_(shaders.get("line_vs.glsl", "line_fs.glsl"))
+{
+  glGenVertexArrays(1, &vao_);
+  glBindVertexArray(vao_);
+
+  glEnableVertexAttribArray(POS_LOCATION);
+  glEnableVertexAttribArray(COLOR_LOCATION);
+
+  glBindVertexArray(0);
+}
+
+LineBatch::~LineBatch()
+{
+  glDeleteVertexArrays(1, &vao_);
+}
+
+void LineBatch::add(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &color)
+{
+  vertices_.push_back(LineVertex{ start, color });
+  vertices_.push_back(LineVertex{ end, color });
+}
+
+void LineBatch::draw(float line_width)
+{
+  DebugLines::collect(vertices_);
+
+  if (vertices_.empty())
+  {
+    return;
+  }
+
+  size_t size = vertices_.size() * sizeof(LineVertex);
+  std::memcpy(stream_.begin(size), vertices_.data(), size);
+  size_t offset = stream_.end();
+
+  program_.use();
+  glBindVertexArray(vao_);
+
+  // sections are aligned to 256 bytes, not to the vertex size, so the offset goes to the pointers rather than to 'first'.
+  glBindBuffer(GL_ARRAY_BUFFER, stream_.id());
+  glVertexAttribPointer(POS_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), reinterpret_cast<void *>(offset + offsetof(LineVertex, pos)));
+  glVertexAttribPointer(COLOR_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(LineVertex), reinterpret_cast<void *>(offset + offsetof(LineVertex, color)));
+
+  glLineWidth(line_width);
+  glDrawArrays(GL_LINES, 0, (GLsizei)vertices_.size());
+  glLineWidth(1.f);
+
+  stream_.fence();
+  vertices_.clear();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Shader.h"
+#include "ShaderRegistry.h"
+#include "StreamBuffer.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct LineVertex
+{
+  glm::vec3 pos;
+  glm::vec3 color;
+};
+
+/**
+ * Transient lines for debugging, e.g. velocities or contact normals, of the last
+ * simulation step. add() may be called from any thread during a step, every thread
+ * appends to its own buffer without locks. begin_step() and collect() run between
+ * steps, on the thread that steps and draws, so they never overlap an add().
+ */
+class DebugLines
+{
+public:
+  // per thread and step, the rest of a step's lines are dropped.
+  static inline constexpr size_t MAX_THREAD_LINES = 1 << 16;
+
+public:
+  static void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+  static bool is_enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // ignored while disabled.
+  static void add(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &color);
+  // drops the lines of the previous step, e.g. of steps that weren't drawn.
+  static void begin_step();
+  // moves the lines of all threads to the end of dst.
+  static void collect(std::vector<LineVertex> &dst);
+
+private:
+  struct ThreadBuffer
+  {
+    std::vector<LineVertex> vertices;
+  };
+
+  static ThreadBuffer &get_thread_buffer();
+
+private:
+  static inline std::atomic<bool> enabled_ = false;
+  static inline std::mutex registry_mutex_; // taken when a thread adds its first line
+  // owned by the registry, so lines of threads that exited are still drawn.
+  static inline std::vector<std::shared_ptr<ThreadBuffer>> registry_;
+};
+
+/**
+ * Draws all lines of a frame, the engine's and DebugLines', with a single call.
+ * Endpoints and colours are written straight to a StreamBuffer, no per-line
+ * matrices or uniforms. Requires a current GL context.
+ */
+class LineBatch
+{
+public:
+  explicit LineBatch(ShaderRegistry &shaders);
+  ~LineBatch();
+  LineBatch(const LineBatch &) = delete;
+  LineBatch &operator=(const LineBatch &) = delete;
+
+public:
+  // render thread only, drawn once by the next draw().
+  void add(const glm::vec3 &start, const glm::vec3 &end, const glm::vec3 &color);
+  void draw(float line_width);
+
+  Shader &get_program() { return program_; }
+
+private:
+  std::vector<LineVertex> vertices_;
+  StreamBuffer stream_;
+  Shader program_;
+  GLuint vao_ = 0;
+};
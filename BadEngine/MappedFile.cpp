@@ -0,0 +1,88 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path)
+{
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+  file_ = file;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size))
+    return;
+
+  size_ = (size_t)size.QuadPart;
+  if (size_ == 0)
+  {
+    // an empty file can't be mapped.
+    open_ = true;
+    return;
+  }
+
+  mapping_ = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping_)
+    return;
+
+  data_ = (const char *)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+  open_ = data_ != nullptr;
+}
+
+MappedFile::~MappedFile()
+{
+  if (data_)
+    UnmapViewOfFile(data_);
+  if (mapping_)
+    CloseHandle(mapping_);
+  if (file_)
+    CloseHandle(file_);
+}
+#else
+MappedFile::MappedFile(const std::string &path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0)
+  {
+    size_ = (size_t)st.st_size;
+    if (size_ == 0)
+    {
+      // an empty file can't be mapped.
+      open_ = true;
+    }
+    else
+    {
+      void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED)
+      {
+        madvise(p, size_, MADV_SEQUENTIAL);
+        data_ = (const char *)p;
+        open_ = true;
+      }
+    }
+  }
+
+  // the mapping outlives the descriptor.
+  close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+  if (data_)
+    munmap((void *)data_, size_);
+}
+#endif
@@ -0,0 +1,473 @@
+#include "MeshGen.h"
+
+#include "gl_incs.h"
+#include "utils.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+  // Newton's, std::sqrt isn't constexpr. starting at or above the root the steps only
+  // decrease, until rounding stops them.
+  constexpr float const_sqrt(float x)
+  {
+    float r = x > 1.f ? x : 1.f;
+    for (int i = 0; i < 16; ++i)
+    {
+      const float next = .5f * (r + x / r);
+      if (!(next < r))
+      {
+        break;
+      }
+      r = next;
+    }
+
+    return r;
+  }
+
+  template <unsigned int LEVEL>
+  struct IcosphereTable
+  {
+    static constexpr size_t VERTICES_N = 10 * ((size_t)1 << (2 * LEVEL)) + 2;
+    static constexpr size_t FACES_N = 20 * ((size_t)1 << (2 * LEVEL));
+
+    // plain arrays, std::array's operator[] costs constexpr steps on every access.
+    float positions[VERTICES_N * 3]{};
+    unsigned int faces[FACES_N * 3]{};
+  };
+
+  constexpr IcosphereTable<0> make_icosahedron()
+  {
+    IcosphereTable<0> table{};
+
+    constexpr float t = 1.6180339887f; // (1 + sqrt(5)) / 2
+    constexpr float n = 1.f / const_sqrt(1.f + t * t);
+    constexpr float positions[] = {
+      -1.f, t, 0.f, 1.f, t, 0.f, -1.f, -t, 0.f, 1.f, -t, 0.f,
+      0.f, -1.f, t, 0.f, 1.f, t, 0.f, -1.f, -t, 0.f, 1.f, -t,
+      t, 0.f, -1.f, t, 0.f, 1.f, -t, 0.f, -1.f, -t, 0.f, 1.f,
+    };
+    constexpr unsigned int faces[] = {
+      0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+      1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+      3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+      4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1,
+    };
+
+    for (size_t i = 0; i < IcosphereTable<0>::VERTICES_N * 3; ++i)
+    {
+      table.positions[i] = positions[i] * n;
+    }
+    for (size_t i = 0; i < IcosphereTable<0>::FACES_N * 3; ++i)
+    {
+      table.faces[i] = faces[i];
+    }
+
+    return table;
+  }
+
+  /**
+   * The next level of a table at compile time, split like the runtime levels so that those
+   * continue from the last table: midpoints are appended in the order the faces first reach
+   * their edges. An edge finds its midpoint among the at most 6 edges of its lower vertex,
+   * constant cost, so the tables stay within the compilers' constexpr step limits.
+   */
+  template <unsigned int LEVEL>
+  constexpr IcosphereTable<LEVEL + 1> subdivide(const IcosphereTable<LEVEL> &coarse)
+  {
+    constexpr size_t COARSE_VERTICES_N = IcosphereTable<LEVEL>::VERTICES_N;
+    constexpr size_t MAX_VALENCE = 6;
+
+    IcosphereTable<LEVEL + 1> table{};
+    size_t vertices_n = COARSE_VERTICES_N;
+
+    for (size_t i = 0; i < COARSE_VERTICES_N * 3; ++i)
+    {
+      table.positions[i] = coarse.positions[i];
+    }
+
+    // per lower vertex, the (higher vertex, midpoint) of its edges split so far.
+    unsigned int edges[COARSE_VERTICES_N * MAX_VALENCE * 2]{};
+    unsigned char edges_n[COARSE_VERTICES_N]{};
+
+    auto midpoint = [&](unsigned int a, unsigned int b)
+    {
+      const unsigned int lo = a < b ? a : b, hi = a < b ? b : a;
+      unsigned int *lo_edges = &edges[lo * MAX_VALENCE * 2];
+      for (size_t e = 0; e < edges_n[lo]; ++e)
+      {
+        if (lo_edges[e * 2] == hi)
+        {
+          return lo_edges[e * 2 + 1];
+        }
+      }
+
+      float m[3] = {};
+      for (size_t c = 0; c < 3; ++c)
+      {
+        m[c] = table.positions[a * 3 + c] + table.positions[b * 3 + c];
+      }
+      const float inv_len = 1.f / const_sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+
+      const unsigned int idx = (unsigned int)vertices_n++;
+      for (size_t c = 0; c < 3; ++c)
+      {
+        table.positions[idx * 3 + c] = m[c] * inv_len;
+      }
+
+      lo_edges[edges_n[lo] * 2] = hi;
+      lo_edges[edges_n[lo] * 2 + 1] = idx;
+      edges_n[lo]++;
+
+      return idx;
+    };
+
+    for (size_t f = 0; f < IcosphereTable<LEVEL>::FACES_N; ++f)
+    {
+      const unsigned int a = coarse.faces[f * 3], b = coarse.faces[f * 3 + 1], c = coarse.faces[f * 3 + 2];
+      const unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+      const unsigned int split[] = { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca };
+
+      for (size_t i = 0; i < 12; ++i)
+      {
+        table.faces[f * 12 + i] = split[i];
+      }
+    }
+
+    return table;
+  }
+
+  // levels up to 1 (42 vertices) are tables, finer ones split the last table at startup. level 2
+  // would take about 4 times level 1's steps, past msvc's default /constexpr:steps of 100000.
+  constexpr IcosphereTable<0> ICOSPHERE_0 = make_icosahedron();
+  constexpr IcosphereTable<1> ICOSPHERE_1 = subdivide(ICOSPHERE_0);
+
+  template <unsigned int LEVEL>
+  void from_table(const IcosphereTable<LEVEL> &table,
+                  std::vector<glm::vec3> &positions,
+                  std::vector<unsigned int> &faces)
+  {
+    positions.resize(IcosphereTable<LEVEL>::VERTICES_N);
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+      positions[i] = glm::vec3(table.positions[i * 3], table.positions[i * 3 + 1], table.positions[i * 3 + 2]);
+    }
+
+    faces.assign(std::begin(table.faces), std::end(table.faces));
+  }
+}
+
+void mesh_gen::icosphere(unsigned int subdivisions,
+                         std::vector<float> &vertices,
+                         std::vector<unsigned int> &indices)
+{
+  std::vector<glm::vec3> positions;
+  std::vector<unsigned int> faces;
+
+  switch (subdivisions)
+  {
+  case 0:
+    from_table(ICOSPHERE_0, positions, faces);
+    break;
+  default:
+    from_table(ICOSPHERE_1, positions, faces);
+    break;
+  }
+
+  for (unsigned int level = 1; level < subdivisions; ++level)
+  {
+    // an edge's midpoint is shared by the two faces on its sides.
+    std::unordered_map<uint64_t, unsigned int> midpoints;
+    midpoints.reserve(faces.size() / 2);
+    auto midpoint = [&](unsigned int a, unsigned int b)
+    {
+      const uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+      auto [it, is_new] = midpoints.try_emplace(key, static_cast<unsigned int>(positions.size()));
+
+      if (is_new)
+      {
+        positions.push_back(glm::normalize(positions[a] + positions[b]));
+      }
+
+      return it->second;
+    };
+
+    std::vector<unsigned int> split_faces;
+    split_faces.reserve(faces.size() * 4);
+
+    for (size_t f = 0; f < faces.size(); f += 3)
+    {
+      unsigned int a = faces[f], b = faces[f + 1], c = faces[f + 2];
+      unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+
+      split_faces.insert(split_faces.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+    }
+
+    faces = std::move(split_faces);
+  }
+
+  vertices.clear();
+  vertices.reserve(positions.size() * 6);
+
+  for (const glm::vec3 &p : positions)
+  {
+    // on a unit sphere the normal is the position.
+    vertices.insert(vertices.end(), { p.x, p.y, p.z, p.x, p.y, p.z });
+  }
+
+  indices = std::move(faces);
+}
+
+void mesh_gen::uv_sphere(unsigned int segments,
+                         unsigned int rings,
+                         std::vector<float> &vertices,
+                         std::vector<unsigned int> &indices)
+{
+  segments = std::max(segments, 3u);
+  rings = std::max(rings, 2u);
+
+  vertices.clear();
+  indices.clear();
+  vertices.reserve((size_t)(segments + 1) * (rings + 1) * 8);
+  indices.reserve((size_t)segments * (rings - 1) * 6);
+
+  // the seam column is duplicated for its u of 1, the poles once per segment.
+  for (unsigned int r = 0; r <= rings; ++r)
+  {
+    const float v = (float)r / rings;
+    const float theta = v * (float)utility::PI;
+
+    for (unsigned int s = 0; s <= segments; ++s)
+    {
+      const float u = (float)s / segments;
+      const float phi = u * 2.f * (float)utility::PI;
+      const glm::vec3 p(std::sin(theta) * std::cos(phi), std::cos(theta), -std::sin(theta) * std::sin(phi));
+
+      vertices.insert(vertices.end(), { p.x, p.y, p.z, p.x, p.y, p.z, u, v });
+    }
+  }
+
+  // counter-clockwise from outside, the pole rings have one triangle per segment.
+  for (unsigned int r = 0; r < rings; ++r)
+  {
+    for (unsigned int s = 0; s < segments; ++s)
+    {
+      const unsigned int a = r * (segments + 1) + s, b = a + segments + 1;
+
+      if (r != 0)
+      {
+        indices.insert(indices.end(), { a, b, a + 1 });
+      }
+      if (r != rings - 1)
+      {
+        indices.insert(indices.end(), { a + 1, b, b + 1 });
+      }
+    }
+  }
+}
+
+void mesh_gen::weld(const float *vertices,
+                    size_t vertices_n,
+                    size_t stride,
+                    std::vector<float> &welded_vertices,
+                    std::vector<unsigned int> &indices)
+{
+  // keyed by the vertex's bytes, so only exact duplicates merge.
+  std::unordered_map<std::string, unsigned int> unique;
+  const size_t vertex_bytes = stride * sizeof(float);
+
+  welded_vertices.clear();
+  indices.clear();
+  indices.reserve(vertices_n);
+
+  for (size_t i = 0; i < vertices_n; ++i)
+  {
+    const float *vertex = vertices + i * stride;
+    std::string key(reinterpret_cast<const char *>(vertex), vertex_bytes);
+    auto [it, is_new] = unique.try_emplace(std::move(key), static_cast<unsigned int>(welded_vertices.size() / stride));
+
+    if (is_new)
+    {
+      welded_vertices.insert(welded_vertices.end(), vertex, vertex + stride);
+    }
+
+    indices.push_back(it->second);
+  }
+}
+namespace
+{
+  // the next vertex to fan around once the current one is done, from the dead-end stack of
+  // recently used vertices or else the first vertex with triangles left.
+  int skip_dead_end(const std::vector<unsigned int> &live,
+                    std::vector<unsigned int> &dead_end,
+                    size_t &cursor)
+  {
+    while (!dead_end.empty())
+    {
+      unsigned int v = dead_end.back();
+      dead_end.pop_back();
+
+      if (live[v] > 0)
+        return (int)v;
+    }
+
+    for (; cursor < live.size(); ++cursor)
+    {
+      if (live[cursor] > 0)
+        return (int)cursor;
+    }
+
+    return -1;
+  }
+}
+
+void mesh_gen::optimize_vertex_cache(std::vector<unsigned int> &indices,
+                                     size_t vertices_n,
+                                     unsigned int cache_size)
+{
+  const size_t triangles_n = indices.size() / 3;
+
+  // the triangles of each vertex, in one array.
+  std::vector<unsigned int> live(vertices_n, 0);
+  for (unsigned int v : indices)
+  {
+    live[v]++;
+  }
+
+  std::vector<size_t> offsets(vertices_n + 1, 0);
+  for (size_t v = 0; v < vertices_n; ++v)
+  {
+    offsets[v + 1] = offsets[v] + live[v];
+  }
+
+  std::vector<unsigned int> adjacency(indices.size());
+  {
+    std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+    }
+  }
+
+  // a vertex is in the cache while time - stamp < cache_size.
+  std::vector<size_t> stamps(vertices_n, 0);
+  size_t time = cache_size + 1;
+
+  std::vector<bool> emitted(triangles_n, false);
+  std::vector<unsigned int> dead_end;
+  std::vector<unsigned int> candidates;
+  std::vector<unsigned int> optimized;
+  optimized.reserve(indices.size());
+
+  size_t cursor = 0;
+  int fanning = skip_dead_end(live, dead_end, cursor);
+
+  while (fanning >= 0)
+  {
+    candidates.clear();
+
+    for (size_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a)
+    {
+      const unsigned int t = adjacency[a];
+      if (emitted[t])
+        continue;
+
+      for (size_t c = 0; c < 3; ++c)
+      {
+        const unsigned int v = indices[t * 3 + c];
+
+        optimized.push_back(v);
+        dead_end.push_back(v);
+        candidates.push_back(v);
+        live[v]--;
+
+        if (time - stamps[v] > cache_size)
+        {
+          stamps[v] = time++;
+        }
+      }
+
+      emitted[t] = true;
+    }
+
+    // the candidate that will still be in the cache after its remaining triangles, the
+    // oldest of those first.
+    int next = -1;
+    long best = -1;
+    for (unsigned int v : candidates)
+    {
+      if (live[v] == 0)
+        continue;
+
+      long priority = 0;
+      if (time - stamps[v] + 2 * live[v] <= cache_size)
+      {
+        priority = (long)(time - stamps[v]);
+      }
+
+      if (priority > best)
+      {
+        best = priority;
+        next = (int)v;
+      }
+    }
+
+    fanning = next >= 0 ? next : skip_dead_end(live, dead_end, cursor);
+  }
+
+  indices = std::move(optimized);
+}
+
+void mesh_gen::optimize_vertex_fetch(std::vector<float> &vertices,
+                                     size_t stride,
+                                     std::vector<unsigned int> &indices)
+{
+  static constexpr unsigned int UNUSED = ~0u;
+
+  std::vector<unsigned int> remap(vertices.size() / stride, UNUSED);
+  std::vector<float> fetched;
+  fetched.reserve(vertices.size());
+
+  for (unsigned int &idx : indices)
+  {
+    if (remap[idx] == UNUSED)
+    {
+      remap[idx] = static_cast<unsigned int>(fetched.size() / stride);
+      fetched.insert(fetched.end(), vertices.begin() + idx * stride, vertices.begin() + (idx + 1) * stride);
+    }
+
+    idx = remap[idx];
+  }
+
+  vertices = std::move(fetched);
+}
+
+float mesh_gen::acmr(const std::vector<unsigned int> &indices,
+                     size_t vertices_n,
+                     unsigned int cache_size)
+{
+  if (indices.empty())
+    return 0.f;
+
+  // fifo: a hit doesn't refresh the vertex's stamp.
+  std::vector<size_t> stamps(vertices_n, 0);
+  size_t time = cache_size + 1;
+  size_t misses = 0;
+
+  for (unsigned int v : indices)
+  {
+    if (time - stamps[v] > cache_size)
+    {
+      stamps[v] = time++;
+      misses++;
+    }
+  }
+
+  return (float)misses / (indices.size() / 3);
+}
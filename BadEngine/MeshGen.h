@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace mesh_gen
+{
+  /**
+   * Unit radius icosphere, an icosahedron whose faces are split in 4 subdivisions times.
+   * vertices are interleaved (pos.xyz, normal.xyz). Levels up to 1 are built at compile
+   * time, finer ones continue from those at runtime.
+   */
+  void icosphere(unsigned int subdivisions,
+                 std::vector<float> &vertices,
+                 std::vector<unsigned int> &indices);
+
+  /**
+   * Unit radius sphere of segments around the y axis and rings from pole to pole, at least
+   * 3 and 2. vertices are interleaved (pos.xyz, normal.xyz, uv), u around and v down.
+   */
+  void uv_sphere(unsigned int segments,
+                 unsigned int rings,
+                 std::vector<float> &vertices,
+                 std::vector<unsigned int> &indices);
+
+  /**
+   * Indexes a triangle list of vertices_n consecutive vertices, stride floats each,
+   * by merging bitwise identical vertices. The welded vertices keep their layout.
+   */
+  void weld(const float *vertices,
+            size_t vertices_n,
+            size_t stride,
+            std::vector<float> &welded_vertices,
+            std::vector<unsigned int> &indices);
+
+  // the fifo post-transform cache the optimisations and acmr() assume.
+  static inline constexpr unsigned int VERTEX_CACHE_SIZE = 16;
+
+  /**
+   * Reorders the triangles for the gpu's post-transform vertex cache with Tipsify (Sander,
+   * Nehab, Barczak 2007), in linear time. Triangles keep their winding.
+   */
+  void optimize_vertex_cache(std::vector<unsigned int> &indices,
+                             size_t vertices_n,
+                             unsigned int cache_size = VERTEX_CACHE_SIZE);
+
+  /**
+   * Renumbers the vertices in the order the triangles first use them, so consecutive
+   * triangles fetch neighbouring vertices. Unreferenced vertices are dropped.
+   */
+  void optimize_vertex_fetch(std::vector<float> &vertices,
+                             size_t stride,
+                             std::vector<unsigned int> &indices);
+
+  // average cache miss ratio: vertex shader invocations per triangle, 3 at worst.
+  float acmr(const std::vector<unsigned int> &indices,
+             size_t vertices_n,
+             unsigned int cache_size = VERTEX_CACHE_SIZE);
+};
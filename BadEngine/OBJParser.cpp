@@ -1,170 +1,373 @@
 #include "OBJParser.h"
-#include <assert.h>
+#include "MappedFile.h"
+#include "MeshGen.h"
+
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <thread>
 
-enum InputType
+namespace
 {
-  VERTEX_E,
-  NORMAL_E,
-  FACE_E,
-  COMMENT_E,
-  UNDEFINED_E
-};
+  // what one chunk of the file holds, merged in file order.
+  struct Chunk
+  {
+    std::vector<float> vertices;
+    std::vector<float> normals;
+    std::vector<float> texcoords;
+    std::vector<unsigned int> face_vertices;
+    std::vector<unsigned int> face_texcoords;
+    std::vector<unsigned int> face_normals;
+    bool success = true;
+  };
 
-OBJParser::OBJParser()
-{
-}
+  bool is_space(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
 
+  const char *skip_spaces(const char *p, const char *end)
+  {
+    while (p < end && is_space(*p))
+      ++p;
+    return p;
+  }
 
-OBJParser::~OBJParser()
-{
-}
+  // false if the line has fewer than N floats, extra ones (a w) are ignored.
+  template <int N>
+  bool parse_floats(const char *p, const char *end, std::vector<float> &out)
+  {
+    float values[N] = {};
+    bool success = true;
 
-bool OBJParser::parse(const std::string &path)
-{
-  bool success = true;
-  std::ifstream fd{ path.c_str() };
-  if (fd.is_open())
+    for (int i = 0; i < N; ++i)
+    {
+      p = skip_spaces(p, end);
+      auto [next, ec] = std::from_chars(p, end, values[i]);
+      if (ec != std::errc())
+      {
+        success = false;
+        break;
+      }
+      p = next;
+    }
+
+    out.insert(out.end(), values, values + N);
+    return success;
+  }
+
+  // v, v/t, v//n or v/t/n. t and n are 0 when missing.
+  bool parse_corner(const char *&p, const char *end, unsigned int &v, unsigned int &t, unsigned int &n)
   {
-    std::string line;
-    while (std::getline(fd, line))
+    auto [next, ec] = std::from_chars(p, end, v);
+    if (ec != std::errc() || v == 0)
+      return false;
+    p = next;
+    t = 0;
+    n = 0;
+
+    if (p < end && *p == '/')
     {
-      InputType t;
-      std::string sign;
-      std::stringstream s{ line };
+      ++p;
+      if (p < end && *p != '/')
+      {
+        auto [t_next, t_ec] = std::from_chars(p, end, t);
+        if (t_ec != std::errc() || t == 0)
+          return false;
+        p = t_next;
+      }
+
+      if (p < end && *p == '/')
+      {
+        ++p;
+        auto [n_next, n_ec] = std::from_chars(p, end, n);
+        if (n_ec != std::errc() || n == 0)
+          return false;
+        p = n_next;
+      }
+    }
 
-      s >> sign;
+    // a corner ends at whitespace, anything else is an index form we don't read.
+    return p == end || is_space(*p);
+  }
 
-      // ignoring 'o' and 'g'
-      if (sign == "#" || sign == "" || sign == "o" || sign == "g")
+  bool parse_face(const char *p, const char *end, Chunk &chunk)
+  {
+    unsigned int first[3] = {}, prev[3] = {};
+    int corners_n = 0;
+
+    for (p = skip_spaces(p, end); p < end; p = skip_spaces(p, end))
+    {
+      unsigned int corner[3];
+      if (!parse_corner(p, end, corner[0], corner[1], corner[2]))
+        return false;
+
+      if (corners_n == 0)
       {
-        t = COMMENT_E;
+        std::copy_n(corner, 3, first);
       }
-      else if (sign == "v")
+      else if (corners_n >= 2)
+      {
+        const unsigned int vs[3] = { first[0], prev[0], corner[0] };
+        const unsigned int ts[3] = { first[1], prev[1], corner[1] };
+        const unsigned int ns[3] = { first[2], prev[2], corner[2] };
+        chunk.face_vertices.insert(chunk.face_vertices.end(), vs, vs + 3);
+        chunk.face_texcoords.insert(chunk.face_texcoords.end(), ts, ts + 3);
+        chunk.face_normals.insert(chunk.face_normals.end(), ns, ns + 3);
+      }
+
+      std::copy_n(corner, 3, prev);
+      corners_n++;
+    }
+
+    return corners_n >= 3;
+  }
+
+  void parse_chunk(const char *p, const char *end, Chunk &chunk)
+  {
+    while (p < end)
+    {
+      const char *eol = (const char *)memchr(p, '\n', end - p);
+      if (!eol)
+        eol = end;
+
+      const char *key = skip_spaces(p, eol);
+      const char *key_end = key;
+      while (key_end < eol && !is_space(*key_end))
+        ++key_end;
+
+      const std::string_view sign(key, key_end - key);
+
+      if (sign == "v")
       {
-        t = VERTEX_E;
+        chunk.success &= parse_floats<3>(key_end, eol, chunk.vertices);
       }
       else if (sign == "vn")
       {
-        t = NORMAL_E;
+        chunk.success &= parse_floats<3>(key_end, eol, chunk.normals);
+      }
+      else if (sign == "vt")
+      {
+        chunk.success &= parse_floats<2>(key_end, eol, chunk.texcoords);
       }
       else if (sign == "f")
       {
-        t = FACE_E;
+        chunk.success &= parse_face(key_end, eol, chunk);
       }
-      else
+      // ignoring comments, objects, groups, smoothing and materials.
+      else if (!(sign.empty() || sign[0] == '#' || sign == "o" || sign == "g" ||
+                 sign == "s" || sign == "usemtl" || sign == "mtllib"))
       {
-        t = UNDEFINED_E;
-        success = false;
+        chunk.success = false;
       }
-      assert(t != UNDEFINED_E);
 
-      switch (t)
-      {
-      case VERTEX_E:
-      {
-        float f;
-        std::vector<float> vec(3);
-        for (int i = 0; s >> f; ++i)
-        {
-          assert(i < 3);
-          vec[i] = f;
-        }
+      p = eol + 1;
+    }
+  }
 
-        vertices_.push_back(std::move(vec));
-      }
-        break;
+  template <class T>
+  void append(std::vector<T> &to, const std::vector<T> &from)
+  {
+    to.insert(to.end(), from.begin(), from.end());
+  }
+}
 
-      case NORMAL_E:
-      {
-        float f;
-        std::vector<float> vec(3);
-        for (int i = 0; s >> f; ++i)
-        {
-          assert(i < 3);
-          vec[i] = f;
-        }
+OBJParser::OBJParser()
+{
+}
 
-        normals_.push_back(std::move(vec));
-      }
-        break;
 
-      case FACE_E:
-      {
-        unsigned int v, n;
-        std::string str;
-        std::vector<unsigned int> vec_v(3), vec_n(3);
-        std::vector<std::pair<unsigned int, unsigned int>> vec_p(3);
+OBJParser::~OBJParser()
+{
+}
 
-        for (int i = 0; i < 3; ++i)
-        {
-          s >> str;
+bool OBJParser::parse(const std::string &path)
+{
+  MappedFile file(path);
+  if (!file.is_open())
+  {
+    return false;
+  }
 
-          std::replace(str.begin(), str.end(), '/', ' ');
+  return parse(file.data(), file.data() + file.size());
+}
 
-          std::stringstream pair_stream(str);
+bool OBJParser::parse(const char *begin, const char *end)
+{
+  const size_t size = end - begin;
+  const size_t threads_n = std::max<size_t>(1, std::thread::hardware_concurrency());
+  const size_t chunks_n = std::clamp<size_t>(size / MIN_CHUNK_SIZE, 1, threads_n);
 
-          pair_stream >> v >> n;
+  // chunks start after a line break, indices in the file are absolute so they parse alone.
+  std::vector<const char *> bounds(chunks_n + 1, end);
+  bounds[0] = begin;
+  for (size_t i = 1; i < chunks_n; ++i)
+  {
+    const char *p = std::max(begin + size * i / chunks_n, bounds[i - 1]);
+    const char *eol = (const char *)memchr(p, '\n', end - p);
+    bounds[i] = eol ? eol + 1 : end;
+  }
 
-          vec_v[i] = v;
-          vec_n[i] = n;
-          vec_p[i] = std::make_pair(v, n);
-        }
+  std::vector<Chunk> chunks(chunks_n);
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < chunks_n; ++i)
+  {
+    threads.emplace_back(parse_chunk, bounds[i], bounds[i + 1], std::ref(chunks[i]));
+  }
+  parse_chunk(bounds[0], bounds[1], chunks[0]);
+  for (std::thread &t : threads)
+  {
+    t.join();
+  }
 
-        face_vertices_indices_.push_back(std::move(vec_v));
-        face_normals_indices_.push_back(std::move(vec_v));
-        face_indices_.push_back(std::move(vec_p));
-      }
-        break;
-      case COMMENT_E:
-        break;
+  bool success = true;
+  if (chunks_n == 1)
+  {
+    vertices_ = std::move(chunks[0].vertices);
+    normals_ = std::move(chunks[0].normals);
+    texcoords_ = std::move(chunks[0].texcoords);
+    face_vertices_indices_ = std::move(chunks[0].face_vertices);
+    face_texcoords_indices_ = std::move(chunks[0].face_texcoords);
+    face_normals_indices_ = std::move(chunks[0].face_normals);
+    success = chunks[0].success;
+  }
+  else
+  {
+    size_t vertices_n = 0, normals_n = 0, texcoords_n = 0, corners_n = 0;
+    for (const Chunk &chunk : chunks)
+    {
+      vertices_n += chunk.vertices.size();
+      normals_n += chunk.normals.size();
+      texcoords_n += chunk.texcoords.size();
+      corners_n += chunk.face_vertices.size();
+    }
 
-      default:
-      {
-        assert(0);
-        success = false;
-      }
+    vertices_.clear();
+    normals_.clear();
+    texcoords_.clear();
+    face_vertices_indices_.clear();
+    face_texcoords_indices_.clear();
+    face_normals_indices_.clear();
 
-      }
+    vertices_.reserve(vertices_n);
+    normals_.reserve(normals_n);
+    texcoords_.reserve(texcoords_n);
+    face_vertices_indices_.reserve(corners_n);
+    face_texcoords_indices_.reserve(corners_n);
+    face_normals_indices_.reserve(corners_n);
+
+    for (const Chunk &chunk : chunks)
+    {
+      append(vertices_, chunk.vertices);
+      append(normals_, chunk.normals);
+      append(texcoords_, chunk.texcoords);
+      append(face_vertices_indices_, chunk.face_vertices);
+      append(face_texcoords_indices_, chunk.face_texcoords);
+      append(face_normals_indices_, chunk.face_normals);
+      success &= chunk.success;
     }
   }
 
-  process();
+  success &= process();
 
   return success;
 }
-#define VERTEX_SIZE 6
-void OBJParser::process()
+bool OBJParser::process()
 {
-  final_vertices_n_normals_.resize(vertices_.size() * VERTEX_SIZE);
-  std::vector<bool> processed(vertices_.size(), false);
-  size_t faces_n = face_vertices_indices_.size();
-  indices_.reserve(faces_n * 3);
-  //for each face
-  for (size_t i = 0; i < faces_n; ++i)
-  {
-    auto face = face_indices_[i];
-    // for each vertex in face
-    for (size_t j = 0; j < face.size(); ++j)
+  const size_t vertices_n = vertices_.size() / 3;
+  const size_t normals_n = normals_.size() / 3;
+  const size_t texcoords_n = texcoords_.size() / 2;
+  const size_t corners_n = face_vertices_indices_.size() / 3 * 3;
+
+  // open addressing over the unique (v, t, n) corners, a slot holds a welded vertex. sized
+  // for about one welded vertex per position, doubled when half full.
+  static constexpr unsigned int EMPTY = ~0u;
+  size_t slots_n = 16;
+  while (slots_n < vertices_n * 2)
+    slots_n *= 2;
+  std::vector<unsigned int> slots(slots_n, EMPTY);
+  std::vector<unsigned int> welded_keys; // (v, t, n) of each welded vertex
+  welded_keys.reserve(vertices_n * 3);
+
+  auto find_slot = [&](const unsigned int *key)
+  {
+    uint64_t hash = key[0] * 0x9E3779B97F4A7C15ull ^ key[1] * 0xC2B2AE3D27D4EB4Full ^ key[2] * 0x165667B19E3779F9ull;
+    size_t slot = (size_t)(hash ^ (hash >> 29)) & (slots_n - 1);
+
+    while (slots[slot] != EMPTY && !std::equal(key, key + 3, &welded_keys[slots[slot] * 3]))
+    {
+      slot = (slot + 1) & (slots_n - 1);
+    }
+
+    return slot;
+  };
+
+  final_vertices_n_normals_.clear();
+  final_vertices_n_normals_.reserve(vertices_n * VERTEX_SIZE);
+  indices_.clear();
+  indices_.reserve(corners_n);
+
+  bool success = true;
+  for (size_t i = 0; i < corners_n; i += 3)
+  {
+    bool valid = true;
+    for (size_t j = i; j < i + 3; ++j)
+    {
+      valid &= face_vertices_indices_[j] <= vertices_n && face_texcoords_indices_[j] <= texcoords_n &&
+               face_normals_indices_[j] <= normals_n;
+    }
+
+    if (!valid)
+    {
+      success = false;
+      continue;
+    }
+
+    for (size_t j = i; j < i + 3; ++j)
     {
-      auto vind = face[j].first;
-      auto nind = face[j].second;
-      indices_.push_back(vind - 1); // we count from 0, not from 1 like in obj files.
+      const unsigned int key[3] = { face_vertices_indices_[j], face_texcoords_indices_[j], face_normals_indices_[j] };
+      size_t slot = find_slot(key);
 
-      if (!processed[vind-1])
+      if (slots[slot] == EMPTY)
       {
-        processed[vind-1] = true;
+        const unsigned int welded = (unsigned int)(welded_keys.size() / 3);
+        if ((welded + 1) * 2 > slots_n)
+        {
+          slots_n *= 2;
+          slots.assign(slots_n, EMPTY);
+          for (unsigned int w = 0; w < welded; ++w)
+          {
+            slots[find_slot(&welded_keys[w * 3])] = w;
+          }
+          slot = find_slot(key);
+        }
 
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 0] = vertices_[vind - 1][0];
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 1] = vertices_[vind - 1][1];
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 2] = vertices_[vind - 1][2];
+        slots[slot] = welded;
+        welded_keys.insert(welded_keys.end(), key, key + 3);
 
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 3] = normals_[nind - 1][0];
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 4] = normals_[nind - 1][1];
-        final_vertices_n_normals_[((vind - 1) * VERTEX_SIZE) + 5] = normals_[nind - 1][2];
+        // 1-based like in the file, 0 is a missing normal or uv, left zero.
+        float vertex[VERTEX_SIZE] = {};
+        std::copy_n(&vertices_[(key[0] - 1) * 3], 3, vertex);
+        if (key[2] > 0)
+          std::copy_n(&normals_[(key[2] - 1) * 3], 3, vertex + 3);
+        if (key[1] > 0)
+          std::copy_n(&texcoords_[(key[1] - 1) * 2], 2, vertex + 6);
+
+        final_vertices_n_normals_.insert(final_vertices_n_normals_.end(), vertex, vertex + VERTEX_SIZE);
       }
-    }
 
+      indices_.push_back(slots[slot]);
+    }
   }
 
-}
\ No newline at end of file
+  const size_t welded_n = final_vertices_n_normals_.size() / VERTEX_SIZE;
+  acmr_before_ = mesh_gen::acmr(indices_, welded_n);
+  mesh_gen::optimize_vertex_cache(indices_, welded_n);
+  mesh_gen::optimize_vertex_fetch(final_vertices_n_normals_, VERTEX_SIZE, indices_);
+  acmr_after_ = mesh_gen::acmr(indices_, welded_n);
+
+  return success;
+}
@@ -1,46 +1,62 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
-#include <sstream>
-#include <fstream>
 #include <vector>
-#include <iostream>
-#include <utility>
-
-//struct face
-//{
-//  unsigned int sz;
-//  float *verts;
-//  float *verts_normals;
-//};
 
+/**
+ * Reads the v, vt, vn and f lines of an obj, faces of any size are triangulated as fans. The
+ * file is mapped and tokenised in place, large files in chunks on all cores. Corners with
+ * the same (v, vt, vn) are welded into one vertex, then the triangles are ordered for the
+ * vertex cache and the vertices for fetching.
+ */
 class OBJParser
 {
+public:
+  // files smaller than two chunks are parsed on the calling thread.
+  static inline constexpr size_t MIN_CHUNK_SIZE = 1 << 20;
+  // pos.xyz, normal.xyz, uv, like GeometryBuffer.
+  static inline constexpr size_t VERTEX_SIZE = 8;
+
 public:
   OBJParser();
   ~OBJParser();
 
 public:
+  // false if the file can't be read or has lines or indices it doesn't understand, those
+  // are skipped.
   bool parse(const std::string &path);
-  std::vector<std::vector<float>> get_vertices() const { return vertices_; }
-  std::vector<std::vector<unsigned int>> get_face_indices() const { return face_vertices_indices_; }
-  std::vector<std::vector<float>> get_normals() const { return normals_; }
-  std::vector<std::vector<unsigned int>> get_face_normal_indices() const { return face_normals_indices_; }
-  std::vector<float> get_data() const { return final_vertices_n_normals_; }
-  std::vector<unsigned int> get_indices() const { return indices_; }
+  bool parse(const char *begin, const char *end);
+  // xyz each.
+  const std::vector<float> &get_vertices() const { return vertices_; }
+  const std::vector<float> &get_normals() const { return normals_; }
+  // uv each.
+  const std::vector<float> &get_texcoords() const { return texcoords_; }
+  // 1-based like in the file, three per triangle. 0 for a corner without a uv or normal.
+  const std::vector<unsigned int> &get_face_indices() const { return face_vertices_indices_; }
+  const std::vector<unsigned int> &get_face_texcoord_indices() const { return face_texcoords_indices_; }
+  const std::vector<unsigned int> &get_face_normal_indices() const { return face_normals_indices_; }
+  // VERTEX_SIZE floats per welded vertex, a missing normal or uv is zero.
+  const std::vector<float> &get_data() const { return final_vertices_n_normals_; }
+  const std::vector<unsigned int> &get_indices() const { return indices_; }
+  // transformed vertices per triangle in mesh_gen's fifo cache, in file order and after
+  // the optimisation.
+  float get_acmr_before() const { return acmr_before_; }
+  float get_acmr_after() const { return acmr_after_; }
 
 private:
-  void process();
+  bool process();
 
 private:
-  std::vector<std::vector<float>> vertices_;
-  std::vector<std::vector<float>> normals_;
-  std::vector<std::vector<unsigned int>> face_vertices_indices_;
-  std::vector<std::vector<unsigned int>> face_normals_indices_;
-  std::vector<std::vector<std::pair<unsigned int, unsigned int>>> face_indices_;
+  std::vector<float> vertices_;
+  std::vector<float> normals_;
+  std::vector<float> texcoords_;
+  std::vector<unsigned int> face_vertices_indices_;
+  std::vector<unsigned int> face_texcoords_indices_;
+  std::vector<unsigned int> face_normals_indices_;
 
   std::vector<float> final_vertices_n_normals_;
   std::vector<unsigned int> indices_;
+  float acmr_before_ = 0.f;
+  float acmr_after_ = 0.f;
 };
-
-
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cassert>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Objects of one type in chunks of CHUNK_SIZE slots. Addresses are stable, chunks are never
+ * moved or freed before clear(). Objects created one after the other lie next to each other,
+ * and destroyed slots are reused through a free list threaded through them.
+ */
+template <class T, size_t CHUNK_SIZE = 256>
+class ObjectPool
+{
+public:
+  ObjectPool() = default;
+  ~ObjectPool() { clear(); }
+  ObjectPool(const ObjectPool &) = delete;
+  ObjectPool &operator=(const ObjectPool &) = delete;
+
+public:
+  template <class... Args>
+  T *create(Args &&...args)
+  {
+    if (!free_)
+      add_chunk();
+
+    Slot *slot = free_;
+    free_ = slot->next_free;
+
+    T *object;
+    try
+    {
+      object = new (slot->storage) T(std::forward<Args>(args)...);
+    }
+    catch (...)
+    {
+      slot->next_free = free_;
+      free_ = slot;
+      throw;
+    }
+
+    slot->live = true;
+    size_++;
+
+    return object;
+  }
+
+  void destroy(T *object)
+  {
+    Slot *slot = reinterpret_cast<Slot *>(object);
+    assert(slot->live);
+
+    object->~T();
+    slot->live = false;
+    slot->next_free = free_;
+    free_ = slot;
+    size_--;
+  }
+
+  // destroys the live objects in memory order and frees the chunks.
+  void clear()
+  {
+    for_each([](T &object) { object.~T(); });
+    chunks_.clear();
+    free_ = nullptr;
+    size_ = 0;
+  }
+
+  // live objects in memory order.
+  template <class Func>
+  void for_each(Func &&func)
+  {
+    for (std::unique_ptr<Slot[]> &chunk : chunks_)
+    {
+      for (size_t i = 0; i < CHUNK_SIZE; ++i)
+      {
+        if (chunk[i].live)
+          func(*reinterpret_cast<T *>(chunk[i].storage));
+      }
+    }
+  }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return chunks_.size() * CHUNK_SIZE; }
+
+private:
+  // the object first, so its address is the slot's. the flag is next to it, so create()
+  // and destroy() don't have to look up the slot's chunk.
+  struct Slot
+  {
+    union
+    {
+      Slot *next_free;
+      alignas(T) unsigned char storage[sizeof(T)];
+    };
+    bool live = false;
+  };
+
+  void add_chunk()
+  {
+    auto chunk = std::make_unique<Slot[]>(CHUNK_SIZE);
+
+    // pushed last to first, so the chunk fills front to back.
+    for (size_t i = CHUNK_SIZE; i-- > 0;)
+    {
+      chunk[i].next_free = free_;
+      free_ = &chunk[i];
+    }
+
+    chunks_.push_back(std::move(chunk));
+  }
+
+private:
+  std::vector<std::unique_ptr<Slot[]>> chunks_;
+  Slot *free_ = nullptr;
+  size_t size_ = 0;
+};
@@ -0,0 +1,177 @@
+#include "OffscreenContext.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef __linux__
+#include <EGL/eglext.h>
+
+static bool has_extension(const char *extensions, const char *name)
+{
+  return extensions && std::strstr(extensions, name);
+}
+
+static EGLDisplay get_display()
+{
+  // mesa's surfaceless platform needs neither X nor wayland.
+  if (has_extension(eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS), "EGL_MESA_platform_surfaceless"))
+  {
+    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+
+    if (get_platform_display)
+    {
+      return get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+  }
+
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+OffscreenContext::OffscreenContext(int width, int height) : width_(width),
+                                                            height_(height)
+{
+  display_ = get_display();
+
+  if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, NULL, NULL))
+  {
+    throw std::runtime_error("Cannot initialize an EGL display.");
+  }
+
+  if (!eglBindAPI(EGL_OPENGL_API))
+  {
+    throw std::runtime_error("EGL has no desktop OpenGL.");
+  }
+
+  static constexpr EGLint CONFIG_ATTRIBS[] = {
+    EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+    EGL_RED_SIZE, 8,
+    EGL_GREEN_SIZE, 8,
+    EGL_BLUE_SIZE, 8,
+    EGL_NONE
+  };
+  EGLConfig config = NULL;
+  EGLint configs_n = 0;
+
+  eglChooseConfig(display_, CONFIG_ATTRIBS, &config, 1, &configs_n);
+
+  const bool surfaceless = has_extension(eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+
+  if (configs_n == 0 && !surfaceless)
+  {
+    throw std::runtime_error("No EGL config for an OpenGL pbuffer.");
+  }
+
+  // the frames go to the fbo, the pbuffer only makes the context current.
+  if (configs_n > 0)
+  {
+    static constexpr EGLint PBUFFER_ATTRIBS[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+    surface_ = eglCreatePbufferSurface(display_, config, PBUFFER_ATTRIBS);
+  }
+
+  static constexpr EGLint CONTEXT_ATTRIBS[] = {
+    EGL_CONTEXT_MAJOR_VERSION, 4,
+    EGL_CONTEXT_MINOR_VERSION, 0,
+    EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+    EGL_NONE
+  };
+
+  context_ = eglCreateContext(display_, (configs_n > 0) ? config : EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, CONTEXT_ATTRIBS);
+
+  if (context_ == EGL_NO_CONTEXT)
+  {
+    throw std::runtime_error("Cannot create an OpenGL 4.0 core EGL context.");
+  }
+
+  if (!eglMakeCurrent(display_, surface_, surface_, context_))
+  {
+    throw std::runtime_error("Cannot make the EGL context current.");
+  }
+}
+
+OffscreenContext::~OffscreenContext()
+{
+  if (fbo_)
+  {
+    glDeleteRenderbuffers(sizeof(renderbuffers_) / sizeof(renderbuffers_[0]), renderbuffers_);
+    glDeleteFramebuffers(1, &fbo_);
+  }
+
+  if (display_ != EGL_NO_DISPLAY)
+  {
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+    if (context_ != EGL_NO_CONTEXT)
+      eglDestroyContext(display_, context_);
+    if (surface_ != EGL_NO_SURFACE)
+      eglDestroySurface(display_, surface_);
+
+    eglTerminate(display_);
+  }
+}
+
+#else
+
+OffscreenContext::OffscreenContext(int width, int height) : width_(width),
+                                                            height_(height)
+{
+  if (glfwInit() == GL_FALSE)
+  {
+    throw std::runtime_error("Cannot initiate opengl.");
+  }
+
+  glfwWindowHint(GLFW_VISIBLE, GL_FALSE);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+  glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+  glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+  window_ = glfwCreateWindow(1, 1, "", NULL, NULL);
+
+  if (window_ == NULL)
+  {
+    throw std::runtime_error("Cannot create a hidden opengl window.");
+  }
+
+  glfwMakeContextCurrent(window_);
+}
+
+OffscreenContext::~OffscreenContext()
+{
+  if (fbo_)
+  {
+    glDeleteRenderbuffers(sizeof(renderbuffers_) / sizeof(renderbuffers_[0]), renderbuffers_);
+    glDeleteFramebuffers(1, &fbo_);
+  }
+
+  if (window_)
+  {
+    glfwDestroyWindow(window_);
+  }
+}
+
+#endif
+
+void OffscreenContext::init_framebuffer()
+{
+  glGenRenderbuffers(sizeof(renderbuffers_) / sizeof(renderbuffers_[0]), renderbuffers_);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[0]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width_, height_);
+  glBindRenderbuffer(GL_RENDERBUFFER, renderbuffers_[1]);
+  glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width_, height_);
+
+  glGenFramebuffers(1, &fbo_);
+  glBindFramebuffer(GL_FRAMEBUFFER, fbo_);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffers_[0]);
+  glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderbuffers_[1]);
+
+  GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    throw std::runtime_error("Offscreen framebuffer incomplete, status " + std::to_string(status) + ".");
+  }
+
+  // a context made current without a window's surface starts with an empty viewport.
+  glViewport(0, 0, width_, height_);
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "gl_incs.h"
+
+#ifdef __linux__
+#include <EGL/egl.h>
+#endif
+
+/**
+ * A GL context without a visible window, rendering to an fbo of a fixed size.
+ *
+ * On linux this is an EGL context on a 1x1 pbuffer (or no surface at all), so it
+ * needs no X display and runs on Mesa's software rasteriser when there is no gpu.
+ * Elsewhere it is a hidden GLFW window.
+ */
+class OffscreenContext
+{
+public:
+  // creates the context and makes it current, throws std::runtime_error on failure.
+  OffscreenContext(int width, int height);
+  ~OffscreenContext();
+  OffscreenContext(const OffscreenContext &) = delete;
+  OffscreenContext &operator=(const OffscreenContext &) = delete;
+
+public:
+  // once the gl functions are loaded. leaves the fbo bound and the viewport set.
+  void init_framebuffer();
+
+  GLuint framebuffer() const { return fbo_; }
+  int get_width() const { return width_; }
+  int get_height() const { return height_; }
+
+private:
+  const int width_, height_;
+#ifdef __linux__
+  EGLDisplay display_ = EGL_NO_DISPLAY;
+  EGLSurface surface_ = EGL_NO_SURFACE;
+  EGLContext context_ = EGL_NO_CONTEXT;
+#else
+  GLFWwindow *window_ = nullptr;
+#endif
+  GLuint fbo_ = 0;
+  GLuint renderbuffers_[2] = { 0 }; // color, depth
+};
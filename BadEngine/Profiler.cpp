@@ -0,0 +1,347 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+  thread_local unsigned int scope_depth = 0;
+}
+
+Profiler &Profiler::get()
+{
+  static Profiler profiler;
+  return profiler;
+}
+
+uint64_t Profiler::now_ns()
+{
+  static const auto epoch = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+uint64_t Profiler::new_flow_id()
+{
+  static std::atomic<uint64_t> next_id{ 1 };
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+Profiler::ThreadLog &Profiler::get_thread_log()
+{
+  // the registry keeps the log alive after its thread exits so late events are still read.
+  thread_local std::shared_ptr<ThreadLog> log;
+  if (!log)
+  {
+    log = std::make_shared<ThreadLog>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    log->thread = (uint32_t)logs_.size();
+    logs_.push_back(log);
+  }
+  return *log;
+}
+
+void Profiler::push(const Event &event)
+{
+  ThreadLog &log = get_thread_log();
+  uint64_t idx = log.written.load(std::memory_order_relaxed);
+  // orders the slot write after the store of idx, so end_frame() sees the lap when it re-checks.
+  std::atomic_thread_fence(std::memory_order_release);
+  Event &dst = log.events[idx % ThreadLog::CAPACITY];
+  dst = event;
+  dst.trace.thread = log.thread;
+  log.written.store(idx + 1, std::memory_order_release);
+}
+
+void Profiler::record(const char *name, unsigned int depth, uint64_t start_ns, uint64_t end_ns)
+{
+  push({ { name, TraceEvent::Type::zone, 0, start_ns, end_ns - start_ns, 0., 0 }, depth });
+}
+
+void Profiler::record_counter(const char *name, double value)
+{
+  push({ { name, TraceEvent::Type::counter, 0, now_ns(), 0, value, 0 }, 0 });
+}
+
+void Profiler::record_flow(const char *name, TraceEvent::Type type, uint64_t id)
+{
+  push({ { name, type, 0, now_ns(), 0, 0., id }, 0 });
+}
+
+void Profiler::begin_gpu(const char *name)
+{
+  GLuint query;
+  if (free_queries_.empty())
+  {
+    glGenQueries(1, &query);
+  }
+  else
+  {
+    query = free_queries_.back();
+    free_queries_.pop_back();
+  }
+  gpu_frames_.back().emplace_back(name, query);
+  glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void Profiler::end_gpu()
+{
+  glEndQuery(GL_TIME_ELAPSED);
+}
+
+void Profiler::collect_gpu_queries(bool wait)
+{
+  auto &passes = gpu_frames_.front();
+  if (!wait)
+  {
+    // results of a frame become available together, checking the last one is enough.
+    GLint available = GL_TRUE;
+    if (!passes.empty())
+    {
+      glGetQueryObjectiv(passes.back().second, GL_QUERY_RESULT_AVAILABLE, &available);
+    }
+    if (!available)
+    {
+      return;
+    }
+  }
+
+  frame_sums_.clear();
+  for (size_t i = 0; i < passes.size(); ++i)
+  {
+    GLuint64 elapsed_ns;
+    glGetQueryObjectui64v(passes[i].second, GL_QUERY_RESULT, &elapsed_ns);
+    FrameSum &sum = frame_sums_[passes[i].first];
+    sum.ms += elapsed_ns * 1e-6f;
+    sum.first = std::min<uint64_t>(sum.first, i);
+    free_queries_.push_back(passes[i].second);
+  }
+  add_frame_sums(true);
+
+  gpu_frames_.pop_front();
+}
+
+void Profiler::end_frame()
+{
+  uint64_t now = now_ns();
+  // registers the render thread before the lock is taken.
+  const uint32_t thread = get_thread_log().thread;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const bool tracing = trace_ && frame_idx_ >= trace_first_frame_;
+
+  frame_sums_.clear();
+  for (auto &log : logs_)
+  {
+    uint64_t written = log->written.load(std::memory_order_acquire);
+    // the writer lapped us, the oldest events are gone.
+    if (written - log->read > ThreadLog::CAPACITY)
+    {
+      log->read = written - ThreadLog::CAPACITY;
+    }
+    for (; log->read < written; ++log->read)
+    {
+      // copied before it is checked, the writer may be overwriting the slot meanwhile.
+      const Event e = log->events[log->read % ThreadLog::CAPACITY];
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // the writer got to the slot's next lap while it was copied, the copy may be torn.
+      if (log->written.load(std::memory_order_relaxed) - log->read >= ThreadLog::CAPACITY)
+      {
+        continue;
+      }
+      if (tracing)
+      {
+        trace_events_.push_back(e.trace);
+      }
+      if (e.trace.type != TraceEvent::Type::zone)
+      {
+        continue;
+      }
+
+      FrameSum &sum = frame_sums_[e.trace.name];
+      sum.depth = e.depth;
+      sum.ms += e.trace.duration_ns * 1e-6f;
+      sum.first = std::min(sum.first, e.trace.start_ns);
+    }
+  }
+  add_frame_sums(false);
+
+  if (last_frame_ns_)
+  {
+    float frame_ms = (now - last_frame_ns_) * 1e-6f;
+    frame_times_[frames_n_++ % WINDOW_FRAMES] = frame_ms;
+    add_sample("frame", 0, false, frame_ms);
+
+    if (tracing)
+    {
+      trace_events_.push_back({ "frame", TraceEvent::Type::zone, thread, last_frame_ns_, now - last_frame_ns_, 0., 0 });
+      trace_events_.push_back({ "frame ms", TraceEvent::Type::counter, thread, now, 0, frame_ms, 0 });
+    }
+  }
+  last_frame_ns_ = now;
+
+  if (tracing)
+  {
+    // the vector's storage moves to the writer, the next frame starts a new one.
+    trace_->submit(std::move(trace_events_));
+    trace_events_ = {};
+  }
+  ++frame_idx_;
+  if (trace_ && frame_idx_ >= trace_end_frame_)
+  {
+    trace_->finish();
+    trace_.reset();
+  }
+
+  // never stall on the gpu unless it fell more than GPU_LATENCY_FRAMES behind.
+  while (gpu_frames_.size() > 1)
+  {
+    size_t pending = gpu_frames_.size();
+    collect_gpu_queries(pending > GPU_LATENCY_FRAMES);
+    if (gpu_frames_.size() == pending)
+    {
+      break;
+    }
+  }
+  gpu_frames_.emplace_back();
+}
+
+void Profiler::add_frame_sums(bool gpu)
+{
+  std::vector<std::pair<std::string_view, FrameSum>> sums(frame_sums_.begin(), frame_sums_.end());
+  std::sort(sums.begin(), sums.end(), [](const auto &a, const auto &b) { return a.second.first < b.second.first; });
+  for (const auto &[name, sum] : sums)
+  {
+    add_sample(name, sum.depth, gpu, sum.ms);
+  }
+}
+
+void Profiler::add_sample(std::string_view name, unsigned int depth, bool gpu, float ms)
+{
+  std::string key = (gpu ? "gpu " : "cpu ") + std::string(name);
+  auto it = series_idx_.find(key);
+  if (it == series_idx_.end())
+  {
+    it = series_idx_.emplace(key, series_.size()).first;
+    series_.push_back({ std::string(name), depth, gpu });
+  }
+  Series &series = series_[it->second];
+  series.depth = depth;
+  series.samples[series.samples_n++ % WINDOW_FRAMES] = ms;
+}
+
+Profiler::Stats Profiler::get_stats(const Series &series)
+{
+  size_t n = std::min(series.samples_n, WINDOW_FRAMES);
+  std::vector<float> sorted(series.samples.begin(), series.samples.begin() + n);
+  std::sort(sorted.begin(), sorted.end());
+
+  float sum = 0.f;
+  for (float ms : sorted)
+  {
+    sum += ms;
+  }
+
+  Stats stats{ series.name, series.depth, series.gpu };
+  stats.last_ms = series.samples[(series.samples_n - 1) % WINDOW_FRAMES];
+  stats.min_ms = sorted.front();
+  stats.mean_ms = sum / n;
+  stats.p99_ms = sorted[std::min(n - 1, n * 99 / 100)];
+  return stats;
+}
+
+std::vector<Profiler::Stats> Profiler::get_stats() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  std::vector<Stats> stats;
+  stats.reserve(series_.size());
+  for (const auto &series : series_)
+  {
+    if (!series.gpu)
+    {
+      stats.push_back(get_stats(series));
+    }
+  }
+  for (const auto &series : series_)
+  {
+    if (series.gpu)
+    {
+      stats.push_back(get_stats(series));
+    }
+  }
+  return stats;
+}
+
+std::vector<float> Profiler::get_frame_times() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  size_t n = std::min(frames_n_, WINDOW_FRAMES);
+  std::vector<float> times;
+  times.reserve(n);
+  for (size_t i = frames_n_ - n; i < frames_n_; ++i)
+  {
+    times.push_back(frame_times_[i % WINDOW_FRAMES]);
+  }
+  return times;
+}
+
+void Profiler::start_trace(const std::string &path, size_t frames_n, size_t delay_frames)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (trace_)
+  {
+    trace_->finish();
+  }
+
+  trace_ = std::make_unique<TraceWriter>(path);
+  if (!trace_->is_open())
+  {
+    trace_.reset();
+    throw std::runtime_error("Cannot open trace file " + path + ".");
+  }
+
+  trace_first_frame_ = frame_idx_ + delay_frames;
+  trace_end_frame_ = frames_n ? trace_first_frame_ + frames_n : std::numeric_limits<size_t>::max();
+}
+
+void Profiler::stop_trace()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (trace_)
+  {
+    trace_->finish();
+    trace_.reset();
+  }
+}
+
+bool Profiler::is_tracing() const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return trace_ != nullptr;
+}
+
+ProfileScope::ProfileScope(const char *name)
+  : name_(name), depth_(scope_depth++), start_ns_(Profiler::now_ns())
+{
+#ifdef BE_TRACK_ALLOCS
+  allocs_start_ = AllocTracker::get_thread_counts();
+#endif
+}
+
+ProfileScope::~ProfileScope()
+{
+  Profiler::get().record(name_, depth_, start_ns_, Profiler::now_ns());
+  --scope_depth;
+
+#ifdef BE_TRACK_ALLOCS
+  // taken after record() so the first events of a thread count against the scope.
+  AllocTracker::Counts end = AllocTracker::get_thread_counts();
+  AllocTracker::get().add_phase(name_, { end.allocs - allocs_start_.allocs, end.bytes - allocs_start_.bytes });
+#endif
+}
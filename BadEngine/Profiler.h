@@ -0,0 +1,186 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "TraceWriter.h"
+#include "AllocTracker.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Frame profiler. Cpu scopes, counters and flows go to a ring buffer per thread without
+ * locks, gpu passes are timed with GL_TIME_ELAPSED queries that are read a few frames
+ * later. end_frame() folds scopes and passes into rolling statistics per name over the
+ * last WINDOW_FRAMES frames and, while a trace is captured, hands the frame's events
+ * to a TraceWriter.
+ *
+ * Use the macros, they compile to nothing without BE_PROFILE:
+ *   PROFILE_SCOPE("integrate");          // cpu, any thread, nestable
+ *   PROFILE_GPU_SCOPE("shapes");         // gpu, render thread, not nestable
+ *   PROFILE_COUNTER("contacts", n);      // traces only
+ *   PROFILE_FLOW_BEGIN("dispatch", id);  // traces only, arrows between the enclosing
+ *   PROFILE_FLOW_STEP("dispatch", id);   // scopes of any threads, ids come from
+ *   PROFILE_FLOW_END("dispatch", id);    // Profiler::new_flow_id()
+ *   PROFILE_END_FRAME();                 // once per frame, render thread
+ */
+class Profiler
+{
+public:
+  static inline constexpr size_t WINDOW_FRAMES = 240;
+
+  struct Stats
+  {
+    std::string name;
+    unsigned int depth; // of cpu scopes, 0 for gpu passes
+    bool gpu;
+    float last_ms, min_ms, mean_ms, p99_ms; // per frame, summed over all threads
+  };
+
+public:
+  static Profiler &get();
+  static uint64_t now_ns();
+
+  static uint64_t new_flow_id();
+
+  // called by the macros.
+  void record(const char *name, unsigned int depth, uint64_t start_ns, uint64_t end_ns);
+  void record_counter(const char *name, double value);
+  void record_flow(const char *name, TraceEvent::Type type, uint64_t id);
+  void begin_gpu(const char *name);
+  void end_gpu();
+
+  void end_frame();
+
+  // cpu scopes in order of first appearance, then gpu passes.
+  std::vector<Stats> get_stats() const;
+  // durations of the last frames in milliseconds, oldest first.
+  std::vector<float> get_frame_times() const;
+
+  // writes the events of frames_n frames, or of all frames until stop_trace() if 0, to a
+  // Chrome trace, starting delay_frames frames from now.
+  void start_trace(const std::string &path, size_t frames_n = 0, size_t delay_frames = 0);
+  void stop_trace();
+  bool is_tracing() const;
+
+private:
+  Profiler() = default;
+
+  struct Event
+  {
+    TraceEvent trace;
+    unsigned int depth; // of zones
+  };
+
+  // written only by its thread, read only by end_frame(), which drops the slots the writer
+  // lapped while they were copied.
+  struct ThreadLog
+  {
+    static inline constexpr size_t CAPACITY = 8192;
+
+    std::array<Event, CAPACITY> events;
+    std::atomic<uint64_t> written{ 0 };
+    uint64_t read = 0;
+    uint32_t thread = 0;
+  };
+
+  struct FrameSum
+  {
+    unsigned int depth = 0;
+    float ms = 0.f;
+    uint64_t first = UINT64_MAX; // start of the first occurrence, orders new series
+  };
+
+  struct Series
+  {
+    std::string name;
+    unsigned int depth;
+    bool gpu;
+    std::array<float, WINDOW_FRAMES> samples;
+    size_t samples_n = 0;
+  };
+
+  ThreadLog &get_thread_log();
+  void push(const Event &event);
+  void add_sample(std::string_view name, unsigned int depth, bool gpu, float ms);
+  void add_frame_sums(bool gpu);
+  void collect_gpu_queries(bool wait);
+  static Stats get_stats(const Series &series);
+
+private:
+  static inline constexpr size_t GPU_LATENCY_FRAMES = 3;
+
+  mutable std::mutex mutex_; // registry and series, never taken by record()
+  std::vector<std::shared_ptr<ThreadLog>> logs_;
+  std::vector<Series> series_;
+  std::unordered_map<std::string, size_t> series_idx_;
+  std::unordered_map<std::string_view, FrameSum> frame_sums_; // reused each frame
+
+  // (name, query) of the passes of a frame, oldest frame first.
+  std::deque<std::vector<std::pair<const char *, GLuint>>> gpu_frames_{ 1 };
+  std::vector<GLuint> free_queries_;
+
+  uint64_t last_frame_ns_ = 0;
+  size_t frame_idx_ = 0;
+
+  std::unique_ptr<TraceWriter> trace_;
+  size_t trace_first_frame_ = 0;
+  size_t trace_end_frame_ = 0;
+  std::vector<TraceEvent> trace_events_;
+  std::array<float, WINDOW_FRAMES> frame_times_{};
+  size_t frames_n_ = 0;
+};
+
+class ProfileScope
+{
+public:
+  explicit ProfileScope(const char *name);
+  ~ProfileScope();
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  const char *name_;
+  unsigned int depth_;
+  uint64_t start_ns_;
+#ifdef BE_TRACK_ALLOCS
+  AllocTracker::Counts allocs_start_;
+#endif
+};
+
+class GpuProfileScope
+{
+public:
+  explicit GpuProfileScope(const char *name) { Profiler::get().begin_gpu(name); }
+  ~GpuProfileScope() { Profiler::get().end_gpu(); }
+  GpuProfileScope(const GpuProfileScope &) = delete;
+  GpuProfileScope &operator=(const GpuProfileScope &) = delete;
+};
+
+#ifdef BE_PROFILE
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpu_profile_scope_, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::get().record_counter(name, value)
+#define PROFILE_FLOW_BEGIN(name, id) Profiler::get().record_flow(name, TraceEvent::Type::flow_begin, id)
+#define PROFILE_FLOW_STEP(name, id) Profiler::get().record_flow(name, TraceEvent::Type::flow_step, id)
+#define PROFILE_FLOW_END(name, id) Profiler::get().record_flow(name, TraceEvent::Type::flow_end, id)
+#define PROFILE_END_FRAME() Profiler::get().end_frame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_COUNTER(name, value) ((void)0)
+#define PROFILE_FLOW_BEGIN(name, id) ((void)0)
+#define PROFILE_FLOW_STEP(name, id) ((void)0)
+#define PROFILE_FLOW_END(name, id) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
@@ -0,0 +1,219 @@
+#include "ProfilerOverlay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+// vertex attribute locations, see overlay_vs.glsl.
+static constexpr GLuint POS_LOCATION = 0;
+static constexpr GLuint COLOR_LOCATION = 1;
+static constexpr size_t INITIAL_QUADS_N = 8192;
+
+// pixels per font pixel, glyphs are 3x5.
+static constexpr float FONT_SCALE = 2.f;
+static constexpr float CHAR_ADVANCE = 4 * FONT_SCALE;
+static constexpr float LINE_ADVANCE = 7 * FONT_SCALE;
+
+static constexpr float MARGIN = 10.f;
+static constexpr float PADDING = 8.f;
+static constexpr float GRAPH_HEIGHT = 100.f;
+static constexpr float GRAPH_BAR_WIDTH = 2.f;
+// frame times drawn at full graph height.
+static constexpr float GRAPH_MAX_MS = 1000.f / 30.f;
+static constexpr float BUDGET_MS = 1000.f / 60.f;
+
+static constexpr char GLYPH_CHARS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-_%/()";
+// rows top to bottom, 3 bits each with the left pixel in the most significant bit.
+static constexpr uint16_t GLYPHS[] = {
+  0b111'101'101'101'111, // 0
+  0b010'110'010'010'111, // 1
+  0b111'001'111'100'111, // 2
+  0b111'001'111'001'111, // 3
+  0b101'101'111'001'001, // 4
+  0b111'100'111'001'111, // 5
+  0b111'100'111'101'111, // 6
+  0b111'001'001'001'001, // 7
+  0b111'101'111'101'111, // 8
+  0b111'101'111'001'111, // 9
+  0b010'101'111'101'101, // A
+  0b110'101'110'101'110, // B
+  0b011'100'100'100'011, // C
+  0b110'101'101'101'110, // D
+  0b111'100'110'100'111, // E
+  0b111'100'110'100'100, // F
+  0b011'100'101'101'011, // G
+  0b101'101'111'101'101, // H
+  0b111'010'010'010'111, // I
+  0b001'001'001'101'010, // J
+  0b101'101'110'101'101, // K
+  0b100'100'100'100'111, // L
+  0b101'111'111'101'101, // M
+  0b110'101'101'101'101, // N
+  0b010'101'101'101'010, // O
+  0b110'101'110'100'100, // P
+  0b010'101'101'110'011, // Q
+  0b110'101'110'101'101, // R
+  0b011'100'010'001'110, // S
+  0b111'010'010'010'010, // T
+  0b101'101'101'101'111, // U
+  0b101'101'101'101'010, // V
+  0b101'101'111'111'101, // W
+  0b101'101'010'101'101, // X
+  0b101'101'010'010'010, // Y
+  0b111'001'010'100'111, // Z
+  0b000'000'000'000'010, // .
+  0b000'010'000'010'000, // :
+  0b000'000'111'000'000, // -
+  0b000'000'000'000'111, // _
+  0b101'001'010'100'101, // %
+  0b001'001'010'100'100, // /
+  0b010'100'100'100'010, // (
+  0b010'001'001'001'010, // )
+};
+static_assert(sizeof(GLYPHS) / sizeof(GLYPHS[0]) == sizeof(GLYPH_CHARS) - 1);
+
+static uint16_t get_glyph(char c)
+{
+  const char *it = c ? std::strchr(GLYPH_CHARS, std::toupper((unsigned char)c)) : nullptr;
+
+  // unknown characters are drawn as spaces.
+  return it ? GLYPHS[it - GLYPH_CHARS] : 0;
+}
+
+ProfilerOverlay::ProfilerOverlay(ShaderRegistry &shaders, int screen_width, int screen_height)
+  : screen_width_(screen_width), screen_height_(screen_height),
+    stream_(GL_ARRAY_BUFFER, INITIAL_QUADS_N * 6 * sizeof(OverlayVertex)),
+    program_(shaders.get("overlay_vs.glsl", "line_fs.glsl"))
+{
+  glGenVertexArrays(1, &vao_);
+  glBindVertexArray(vao_);
+
+  glEnableVertexAttribArray(POS_LOCATION);
+  glEnableVertexAttribArray(COLOR_LOCATION);
+
+  glBindVertexArray(0);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+  glDeleteVertexArrays(1, &vao_);
+}
+
+void ProfilerOverlay::add_rect(float x, float y, float w, float h, const glm::vec3 &color)
+{
+  float x0 = 2.f * x / screen_width_ - 1.f;
+  float x1 = 2.f * (x + w) / screen_width_ - 1.f;
+  float y0 = 1.f - 2.f * y / screen_height_;
+  float y1 = 1.f - 2.f * (y + h) / screen_height_;
+
+  vertices_.push_back(OverlayVertex{ { x0, y0 }, color });
+  vertices_.push_back(OverlayVertex{ { x0, y1 }, color });
+  vertices_.push_back(OverlayVertex{ { x1, y1 }, color });
+  vertices_.push_back(OverlayVertex{ { x0, y0 }, color });
+  vertices_.push_back(OverlayVertex{ { x1, y1 }, color });
+  vertices_.push_back(OverlayVertex{ { x1, y0 }, color });
+}
+
+void ProfilerOverlay::add_text(float x, float y, const std::string &text, const glm::vec3 &color)
+{
+  for (char c : text)
+  {
+    uint16_t glyph = get_glyph(c);
+
+    for (int row = 0; row < 5; ++row)
+    {
+      unsigned int bits = (glyph >> (3 * (4 - row))) & 0b111;
+
+      // one quad per horizontal run of lit pixels.
+      for (int col = 0; col < 3;)
+      {
+        if (!(bits & (0b100 >> col)))
+        {
+          ++col;
+          continue;
+        }
+
+        int run = 1;
+        while (col + run < 3 && (bits & (0b100 >> (col + run))))
+        {
+          ++run;
+        }
+
+        add_rect(x + col * FONT_SCALE, y + row * FONT_SCALE, run * FONT_SCALE, FONT_SCALE, color);
+        col += run;
+      }
+    }
+
+    x += CHAR_ADVANCE;
+  }
+}
+
+void ProfilerOverlay::draw(const std::vector<Profiler::Stats> &stats, const std::vector<float> &frame_times)
+{
+  static const glm::vec3 background(.08f, .08f, .1f);
+  static const glm::vec3 header_color(.6f, .6f, .6f);
+  static const glm::vec3 cpu_color(.95f, .95f, .95f);
+  static const glm::vec3 gpu_color(.55f, .8f, 1.f);
+
+  const float graph_width = Profiler::WINDOW_FRAMES * GRAPH_BAR_WIDTH;
+  const float panel_height = (stats.size() + 1) * LINE_ADVANCE + GRAPH_HEIGHT + 3 * PADDING;
+
+  add_rect(MARGIN, MARGIN, graph_width + 2 * PADDING, panel_height, background);
+
+  float x = MARGIN + PADDING;
+  float y = MARGIN + PADDING;
+  char line[128];
+
+  std::snprintf(line, sizeof(line), "%-24s%7s%7s%7s%7s", "SCOPE (MS)", "LAST", "MIN", "MEAN", "P99");
+  add_text(x, y, line, header_color);
+  y += LINE_ADVANCE;
+
+  for (const auto &s : stats)
+  {
+    std::string name = std::string(2 * s.depth, ' ') + (s.gpu ? "gpu " : "") + s.name;
+    std::snprintf(line, sizeof(line), "%-24.24s%7.2f%7.2f%7.2f%7.2f", name.c_str(), s.last_ms, s.min_ms, s.mean_ms, s.p99_ms);
+    add_text(x, y, line, s.gpu ? gpu_color : cpu_color);
+    y += LINE_ADVANCE;
+  }
+
+  // frame times, newest on the right, with the 60 and 30 fps budgets.
+  y += PADDING;
+  float graph_bottom = y + GRAPH_HEIGHT;
+  float bar_x = x + graph_width - frame_times.size() * GRAPH_BAR_WIDTH;
+
+  for (float ms : frame_times)
+  {
+    float h = std::min(ms / GRAPH_MAX_MS, 1.f) * GRAPH_HEIGHT;
+    glm::vec3 color = ms <= BUDGET_MS ? glm::vec3(.3f, .85f, .3f) : (ms <= GRAPH_MAX_MS ? glm::vec3(.95f, .8f, .2f) : glm::vec3(.95f, .3f, .25f));
+
+    add_rect(bar_x, graph_bottom - h, GRAPH_BAR_WIDTH, h, color);
+    bar_x += GRAPH_BAR_WIDTH;
+  }
+
+  add_rect(x, graph_bottom - BUDGET_MS / GRAPH_MAX_MS * GRAPH_HEIGHT, graph_width, 1.f, header_color);
+  add_rect(x, y, graph_width, 1.f, header_color);
+
+  size_t size = vertices_.size() * sizeof(OverlayVertex);
+  std::memcpy(stream_.begin(size), vertices_.data(), size);
+  size_t offset = stream_.end();
+
+  program_.use();
+  glBindVertexArray(vao_);
+
+  glBindBuffer(GL_ARRAY_BUFFER, stream_.id());
+  glVertexAttribPointer(POS_LOCATION, 2, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), reinterpret_cast<void *>(offset + offsetof(OverlayVertex, pos)));
+  glVertexAttribPointer(COLOR_LOCATION, 3, GL_FLOAT, GL_FALSE, sizeof(OverlayVertex), reinterpret_cast<void *>(offset + offsetof(OverlayVertex, color)));
+
+  GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+  glDisable(GL_DEPTH_TEST);
+  glDrawArrays(GL_TRIANGLES, 0, (GLsizei)vertices_.size());
+  if (depth_test)
+  {
+    glEnable(GL_DEPTH_TEST);
+  }
+
+  stream_.fence();
+  vertices_.clear();
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Profiler.h"
+#include "Shader.h"
+#include "ShaderRegistry.h"
+#include "StreamBuffer.h"
+
+#include <string>
+#include <vector>
+
+struct OverlayVertex
+{
+  glm::vec2 pos; // normalized device coordinates
+  glm::vec3 color;
+};
+
+/**
+ * Draws the Profiler's statistics and a graph of the last frame times on top of the
+ * frame: flat coloured quads and a 3x5 bitmap font, all in one draw call.
+ * Requires a current GL context.
+ */
+class ProfilerOverlay
+{
+public:
+  ProfilerOverlay(ShaderRegistry &shaders, int screen_width, int screen_height);
+  ~ProfilerOverlay();
+  ProfilerOverlay(const ProfilerOverlay &) = delete;
+  ProfilerOverlay &operator=(const ProfilerOverlay &) = delete;
+
+public:
+  void draw(const std::vector<Profiler::Stats> &stats, const std::vector<float> &frame_times);
+
+  Shader &get_program() { return program_; }
+
+private:
+  // pixels, origin at the top left.
+  void add_rect(float x, float y, float w, float h, const glm::vec3 &color);
+  void add_text(float x, float y, const std::string &text, const glm::vec3 &color);
+
+private:
+  const int screen_width_;
+  const int screen_height_;
+  std::vector<OverlayVertex> vertices_;
+  StreamBuffer stream_;
+  Shader program_;
+  GLuint vao_ = 0;
+};
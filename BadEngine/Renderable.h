@@ -2,16 +2,36 @@
 
 #include "gl_incs.h"
 
-#include <functional>
-#include "Accessor.h"
+#include <vector>
+
+// Per-instance data the vertex shader builds the model and normal matrices from.
+struct InstancePose
+{
+  glm::vec3 pos;
+  glm::quat orientation;
+  glm::vec3 scale;
+  GLuint material; // index into the Frame block's material colors
+};
+
+static_assert(sizeof(InstancePose) == 11 * sizeof(float), "InstancePose is uploaded as is, keep it packed.");
 
 class Renderable
 {
-  Accessor<glm::mat4> updater_;
+  // owned by the engine, one vector per renderable type.
+  std::vector<InstancePose> *instances_;
+  size_t idx_;
 
 public:
-  Renderable(Accessor<glm::mat4> updater) : updater_(updater)
+  Renderable(std::vector<InstancePose> *instances, size_t idx) : instances_(instances),
+                                                                  idx_(idx)
   {
   }
-  void update_model_transformation(const glm::mat4 &m) { updater_.set(m); }
+  void update_pose(const glm::vec3 &pos, const glm::quat &orientation, const glm::vec3 &scale)
+  {
+    InstancePose &pose = (*instances_)[idx_];
+
+    pose.pos = pos;
+    pose.orientation = orientation;
+    pose.scale = scale;
+  }
 };
\ No newline at end of file
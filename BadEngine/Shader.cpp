@@ -17,19 +17,90 @@ Shader::Shader(const char *vertex_path, const char *fragment_path)
   load_program(result_, msg_, vertex_path, fragment_path);
 }
 
-void Shader::load_program(GLint &result, vector<GLchar> &msg, const char *vertex_path, const char *fragment_path)
+Shader::Shader(const char *vertex_path, const char *fragment_path, const vector<string> &defines)
+{
+  load_program(result_, msg_, vertex_path, fragment_path, defines);
+}
+
+Shader::Shader(GLuint program) : program_(program)
+{
+  cache_uniform_locations();
+}
+
+static string read_stage_file(const string &path)
+{
+  return utility::read_file(path.c_str());
+}
+
+void Shader::load_program(GLint &result, vector<GLchar> &msg, const char *vertex_path, const char *fragment_path, const vector<string> &defines)
+{
+  load_program_from_sources(result, msg, load_source(vertex_path, defines, read_stage_file),
+                            load_source(fragment_path, defines, read_stage_file));
+}
+
+void Shader::load_program_from_sources(GLint &result, vector<GLchar> &msg, const string &vertex_src, const string &fragment_src)
 {
   program_ = 0;
 
-  vert_shader_ = load_shader(vertex_path, GL_VERTEX_SHADER, result, msg);
+  vert_shader_ = load_shader(vertex_src, GL_VERTEX_SHADER, result, msg);
 
 
   if (result == GL_TRUE)
-    frag_shader_ = load_shader(fragment_path, GL_FRAGMENT_SHADER, result, msg);
+    frag_shader_ = load_shader(fragment_src, GL_FRAGMENT_SHADER, result, msg);
   if (result == GL_TRUE)
     program_ = load_program(vert_shader_, frag_shader_, result, msg);
 
   error_ = (result == GL_FALSE);
+
+  if (!error_)
+    cache_uniform_locations();
+}
+
+void Shader::cache_uniform_locations()
+{
+  locations_.clear();
+
+  GLint uniforms_n = 0, max_name_length = 0;
+  glGetProgramiv(program_, GL_ACTIVE_UNIFORMS, &uniforms_n);
+  glGetProgramiv(program_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_name_length);
+
+  vector<GLchar> name(max_name_length + 1);
+
+  for (GLint i = 0; i < uniforms_n; ++i)
+  {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    glGetActiveUniform(program_, i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+    string uniform_name(name.data(), length);
+    GLint location = glGetUniformLocation(program_, uniform_name.c_str());
+
+    // members of uniform blocks have no location.
+    if (location < 0)
+      continue;
+
+    // arrays are reported as "name[0]", allow addressing them as "name" too.
+    if (size_t bracket = uniform_name.find('['); bracket != string::npos)
+      locations_.emplace(uniform_name.substr(0, bracket), location);
+
+    locations_.emplace(std::move(uniform_name), location);
+  }
+}
+
+GLint Shader::get_location(const std::string &name) const
+{
+  auto it = locations_.find(name);
+
+  return (it == locations_.end()) ? -1 : it->second;
+}
+
+void Shader::bind_uniform_block(const char *block_name, GLuint binding) const
+{
+  GLuint block = glGetUniformBlockIndex(program_, block_name);
+
+  if (block != GL_INVALID_INDEX)
+    glUniformBlockBinding(program_, block, binding);
 }
 
 GLuint Shader::load_program(GLuint vertShader, GLuint fragShader, GLint &result, std::vector<GLchar> &msg)
@@ -38,6 +109,9 @@ GLuint Shader::load_program(GLuint vertShader, GLuint fragShader, GLint &result,
 
   glAttachShader(program, vertShader);
   glAttachShader(program, fragShader);
+  // lets ShaderRegistry store the linked binary.
+  if (GLEW_ARB_get_program_binary)
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
   glLinkProgram(program);
 
   glGetProgramiv(program, GL_LINK_STATUS, &result);
@@ -54,11 +128,80 @@ GLuint Shader::load_program(GLuint vertShader, GLuint fragShader, GLint &result,
 }
 
 
-GLuint Shader::load_shader(const char *path, GLenum type, GLint &result, std::vector<GLchar> &msg)
+// GLSL has no includes, expand '#include "file"' lines with the file's content.
+static string resolve_includes(const string &src, const Shader::FileReader &read, int depth = 0)
+{
+  static constexpr int MAX_DEPTH = 8;
+  static const string DIRECTIVE = "#include";
+
+  string res;
+  size_t line_start = 0;
+
+  while (line_start < src.size())
+  {
+    size_t line_end = src.find('\n', line_start);
+    if (line_end == string::npos)
+      line_end = src.size();
+
+    string line = src.substr(line_start, line_end - line_start);
+    size_t directive_pos = line.find_first_not_of(" \t");
+
+    if (directive_pos != string::npos && line.compare(directive_pos, DIRECTIVE.size(), DIRECTIVE) == 0 && depth < MAX_DEPTH)
+    {
+      size_t open = line.find('"', directive_pos);
+      size_t close = (open == string::npos) ? string::npos : line.find('"', open + 1);
+
+      if (close != string::npos)
+        line = resolve_includes(read(line.substr(open + 1, close - open - 1)), read, depth + 1);
+    }
+
+    res += line + "\n";
+    line_start = line_end + 1;
+  }
+
+  return res;
+}
+
+// #version has to stay the first statement, so the defines go right after it.
+static string inject_defines(const string &src, const vector<string> &defines)
+{
+  if (defines.empty())
+  {
+    return src;
+  }
+
+  string define_lines;
+
+  for (const string &define : defines)
+  {
+    define_lines += "#define " + define + "\n";
+  }
+
+  size_t version_pos = src.find("#version");
+  size_t insert_pos = (version_pos == string::npos) ? 0 : src.find('\n', version_pos);
+
+  if (insert_pos == string::npos)
+  {
+    return src + "\n" + define_lines;
+  }
+
+  if (version_pos != string::npos)
+  {
+    ++insert_pos; // past the newline
+  }
+
+  return src.substr(0, insert_pos) + define_lines + src.substr(insert_pos);
+}
+
+string Shader::load_source(const string &path, const vector<string> &defines, const FileReader &read)
+{
+  return inject_defines(resolve_includes(read(path), read), defines);
+}
+
+GLuint Shader::load_shader(const string &src, GLenum type, GLint &result, std::vector<GLchar> &msg)
 {
   GLuint shader = glCreateShader(type);
-  string shaderStr = utility::read_file(path);
-  const char *shaderSrc = shaderStr.c_str();
+  const char *shaderSrc = src.c_str();
 
   int log_length = 0;
 
@@ -85,68 +228,82 @@ GLuint Shader::load_shader(const char *path, GLenum type, GLint &result, std::ve
 
 void Shader::set_bool(const std::string &name, bool value) const
 {
-  glUniform1i(glGetUniformLocation(program_, name.c_str()), (int)value);
+  glUniform1i(get_location(name), (int)value);
 }
 
 void Shader::set_int(const std::string &name, int value) const
 {
-  glUniform1i(glGetUniformLocation(program_, name.c_str()), value);
+  glUniform1i(get_location(name), value);
 }
 
 void Shader::set_float(const std::string &name, float value) const
 {
-  glUniform1f(glGetUniformLocation(program_, name.c_str()), value);
+  glUniform1f(get_location(name), value);
 }
 
 void Shader::set_vec2(const std::string &name, const glm::vec2 &value) const
 {
-  glUniform2fv(glGetUniformLocation(program_, name.c_str()), 1, &value[0]);
+  glUniform2fv(get_location(name), 1, &value[0]);
 }
 void Shader::set_vec2(const std::string &name, float x, float y) const
 {
-  glUniform2f(glGetUniformLocation(program_, name.c_str()), x, y);
+  glUniform2f(get_location(name), x, y);
 }
 
 void Shader::set_vec3(const std::string &name, const glm::vec3 &value) const
 {
-  glUniform3fv(glGetUniformLocation(program_, name.c_str()), 1, &value[0]);
+  glUniform3fv(get_location(name), 1, &value[0]);
 }
 void Shader::set_vec3(const std::string &name, float x, float y, float z) const
 {
-  glUniform3f(glGetUniformLocation(program_, name.c_str()), x, y, z);
+  glUniform3f(get_location(name), x, y, z);
 }
 
 void Shader::set_vec4(const std::string &name, const glm::vec4 &value) const
 {
-  glUniform4fv(glGetUniformLocation(program_, name.c_str()), 1, &value[0]);
+  glUniform4fv(get_location(name), 1, &value[0]);
 }
 void Shader::set_vec4(const std::string &name, float x, float y, float z, float w)
 {
-  glUniform4f(glGetUniformLocation(program_, name.c_str()), x, y, z, w);
+  glUniform4f(get_location(name), x, y, z, w);
 }
 
 void Shader::set_mat2(const std::string &name, const glm::mat2 &mat) const
 {
-  glUniformMatrix2fv(glGetUniformLocation(program_, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  glUniformMatrix2fv(get_location(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::set_mat3(const std::string &name, const glm::mat3 &mat) const
 {
-  glUniformMatrix3fv(glGetUniformLocation(program_, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+  glUniformMatrix3fv(get_location(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::set_mat4(const std::string &name, const glm::mat4 &mat) const
 {
-  auto loc = glGetUniformLocation(program_, name.c_str());
-  glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mat) /** &mat[0][0] */);
+  set_mat4(get_location(name), mat);
 }
 
 void Shader::set_mat4(const std::string &name, const void *mat) const
 {
-  auto loc = glGetUniformLocation(program_, name.c_str());
+  auto loc = get_location(name);
   glUniformMatrix4fv(loc, 1, GL_FALSE, reinterpret_cast<const float *>(mat));
 }
 
+void Shader::set_vec3(GLint location, const glm::vec3 &value) const
+{
+  glUniform3fv(location, 1, &value[0]);
+}
+
+void Shader::set_mat3(GLint location, const glm::mat3 &mat) const
+{
+  glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::set_mat4(GLint location, const glm::mat4 &mat) const
+{
+  glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(mat));
+}
+
 //void Shader::set_tex(const std::string &name, const string &path, bool alpha) const
 //{
 //  GLuint texture = utility::load_texture(path.c_str(), result_, msg_, alpha);
@@ -2,8 +2,10 @@
 
 
 #include "gl_incs.h"
+#include <functional>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 using namespace std;
 class Shader
@@ -11,13 +13,30 @@ class Shader
 public:
   Shader() {}
   Shader(const char *vertex_path, const char *fragment_path);
-  void load_program(GLint &result, std::vector<GLchar> &msg, const char *vertex_path, const char *fragment_path);
+  // defines are injected after the #version line of both stages, e.g. { "UNIFORM_SCALE" }.
+  Shader(const char *vertex_path, const char *fragment_path, const vector<string> &defines);
+  // adopts a linked program, e.g. one restored by glProgramBinary().
+  explicit Shader(GLuint program);
+  void load_program(GLint &result, std::vector<GLchar> &msg, const char *vertex_path, const char *fragment_path, const vector<string> &defines = {});
+  // from sources as returned by load_source().
+  void load_program_from_sources(GLint &result, std::vector<GLchar> &msg, const string &vertex_src, const string &fragment_src);
+
+  // a file's content, "" if it can't be read.
+  using FileReader = std::function<string(const string &path)>;
+  // the stage as compiled: includes expanded and defines injected after #version.
+  static string load_source(const string &path, const vector<string> &defines, const FileReader &read);
+
+  GLuint get_program() const { return program_; }
   bool get_error() const { return error_; }
   bool get_status() const { return result_; }
   vector<GLchar> get_message() const { return msg_; }
   GLint exit_error();
 
   void use() const { glUseProgram(program_); }
+  void bind_uniform_block(const char *block_name, GLuint binding) const;
+
+  // resolved once at link time, -1 for uniforms the program doesn't use.
+  GLint get_location(const std::string &name) const;
 
   void set_bool(const std::string &name, bool value) const;
   void set_int(const std::string &name, int value) const;
@@ -33,13 +52,20 @@ public:
   void set_mat4(const std::string &name, const glm::mat4 &mat) const;
   void set_mat4(const std::string &name, const void *mat) const;
 
+  // for hot paths, with a location from get_location().
+  void set_vec3(GLint location, const glm::vec3 &value) const;
+  void set_mat3(GLint location, const glm::mat3 &mat) const;
+  void set_mat4(GLint location, const glm::mat4 &mat) const;
+
 private:
   GLuint load_program(GLuint vertShader, GLuint fragShader, GLint &result, vector<GLchar> &msg);
-  GLuint load_shader(const char *path, GLenum type, GLint &result, vector<GLchar> &msg);
+  GLuint load_shader(const string &src, GLenum type, GLint &result, vector<GLchar> &msg);
+  void cache_uniform_locations();
 
 private:
   GLuint program_ = 0, vert_shader_ = 0, frag_shader_ = 0;
   GLint result_ = GL_TRUE;
   vector<GLchar> msg_;
   bool error_ = false;
+  std::unordered_map<std::string, GLint> locations_;
 };
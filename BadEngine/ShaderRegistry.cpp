@@ -0,0 +1,187 @@
+#include "ShaderRegistry.h"
+#include "MappedFile.h"
+#include "utils.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+  constexpr char MAGIC[4] = { 'B', 'P', 'R', 'G' };
+  constexpr uint32_t VERSION = 1;
+
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint64_t sources_hash;
+    uint64_t driver_hash;
+    uint32_t format; // glGetProgramBinary()'s
+    uint32_t length; // bytes after the header
+  };
+
+  uint64_t get_driver_hash()
+  {
+    std::string driver;
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION })
+    {
+      const GLubyte *value = glGetString(name);
+      driver += value ? (const char *)value : "";
+      driver += '\n';
+    }
+
+    return utility::hash(driver.data(), driver.size());
+  }
+}
+
+ShaderRegistry::ShaderRegistry(const std::string &cache_dir) : cache_dir_(cache_dir)
+{
+  GLint formats_n = 0;
+  if (GLEW_ARB_get_program_binary)
+  {
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats_n);
+  }
+
+  std::error_code ec;
+  cache_enabled_ = formats_n > 0 && (std::filesystem::create_directories(cache_dir_, ec) || !ec);
+  driver_hash_ = get_driver_hash();
+}
+
+ShaderRegistry::~ShaderRegistry()
+{
+  for (auto &[key, program] : programs_)
+  {
+    glDeleteProgram(program.get_program());
+  }
+}
+
+Shader ShaderRegistry::get(const char *vertex_path, const char *fragment_path, const std::vector<std::string> &defines)
+{
+  auto read = [this](const std::string &path) { return read_file(path); };
+  const std::string vertex_src = Shader::load_source(vertex_path, defines, read);
+  const std::string fragment_src = Shader::load_source(fragment_path, defines, read);
+
+  // with the terminators, so no two pairs of stages hash the same bytes.
+  const uint64_t key = utility::hash(fragment_src.c_str(), fragment_src.size() + 1,
+                                     utility::hash(vertex_src.c_str(), vertex_src.size() + 1));
+
+  if (auto it = programs_.find(key); it != programs_.end())
+  {
+    shared_n_++;
+    return it->second;
+  }
+
+  if (GLuint program = restore(key))
+  {
+    restored_n_++;
+    return programs_.emplace(key, Shader(program)).first->second;
+  }
+
+  Shader shader;
+  GLint result = GL_TRUE;
+  std::vector<GLchar> msg;
+  shader.load_program_from_sources(result, msg, vertex_src, fragment_src);
+  compiled_n_++;
+
+  // failed programs are reported by the caller, and compiled again if asked for again.
+  if (shader.get_error())
+    return shader;
+
+  store(key, shader.get_program());
+  return programs_.emplace(key, shader).first->second;
+}
+
+const std::string &ShaderRegistry::read_file(const std::string &path)
+{
+  auto it = files_.find(path);
+  if (it == files_.end())
+  {
+    it = files_.emplace(path, utility::read_file(path.c_str())).first;
+  }
+
+  return it->second;
+}
+
+std::string ShaderRegistry::get_cache_path(uint64_t key) const
+{
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)utility::hash(&driver_hash_, sizeof(driver_hash_), key));
+
+  return (std::filesystem::path(cache_dir_) / name).string();
+}
+
+// 0 if there's no usable binary.
+GLuint ShaderRegistry::restore(uint64_t key)
+{
+  if (!cache_enabled_)
+    return 0;
+
+  MappedFile file(get_cache_path(key));
+  if (!file.is_open() || file.size() < sizeof(Header))
+    return 0;
+
+  Header header;
+  memcpy(&header, file.data(), sizeof(header));
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION || header.sources_hash != key ||
+      header.driver_hash != driver_hash_ || sizeof(Header) + header.length > file.size())
+  {
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.format, file.data() + sizeof(Header), header.length);
+
+  GLint result = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &result);
+  if (result == GL_FALSE)
+  {
+    utility::dbg_print("Stale program binary, compiling.");
+    glDeleteProgram(program);
+    return 0;
+  }
+
+  return program;
+}
+
+// through a temporary like BinaryMesh, a failed store only costs a compile next run.
+void ShaderRegistry::store(uint64_t key, GLuint program) const
+{
+  if (!cache_enabled_)
+    return;
+
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+
+  std::vector<char> binary(length);
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &length, &format, binary.data());
+
+  Header header{};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.sources_hash = key;
+  header.driver_hash = driver_hash_;
+  header.format = format;
+  header.length = (uint32_t)length;
+
+  const std::string path = get_cache_path(key);
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write((const char *)&header, sizeof(header));
+    out.write(binary.data(), length);
+
+    if (!out)
+      return;
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec)
+    std::filesystem::remove(tmp_path, ec);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Shader.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Loads programs once per distinct source, keyed by the hash of both stages as compiled, so
+ * programs with the same files and defines share one gl program. Linked programs are stored
+ * with glGetProgramBinary() in cache_dir, keyed by the sources and the driver, and later
+ * runs restore them with glProgramBinary() without compiling any GLSL. A binary the driver
+ * rejects, e.g. after an update that kept the version string, is compiled and stored again.
+ * Requires a current GL context, and owns the programs.
+ */
+class ShaderRegistry
+{
+public:
+  explicit ShaderRegistry(const std::string &cache_dir = "shader_cache");
+  ~ShaderRegistry();
+  ShaderRegistry(const ShaderRegistry &) = delete;
+  ShaderRegistry &operator=(const ShaderRegistry &) = delete;
+
+public:
+  // defines as in Shader, check get_error() of the result.
+  Shader get(const char *vertex_path, const char *fragment_path, const std::vector<std::string> &defines = {});
+
+  // false if the driver can't store program binaries, programs are compiled on every run.
+  bool is_cache_enabled() const { return cache_enabled_; }
+  // of the programs returned so far.
+  size_t get_compiled_n() const { return compiled_n_; }
+  size_t get_restored_n() const { return restored_n_; }
+  size_t get_shared_n() const { return shared_n_; }
+
+private:
+  // sources are read once, base_fs.glsl and the includes are shared by most programs.
+  const std::string &read_file(const std::string &path);
+  std::string get_cache_path(uint64_t key) const;
+  GLuint restore(uint64_t key);
+  void store(uint64_t key, GLuint program) const;
+
+private:
+  const std::string cache_dir_;
+  bool cache_enabled_ = false;
+  // vendor, renderer and version strings, a new driver misses all binaries.
+  uint64_t driver_hash_ = 0;
+  std::unordered_map<uint64_t, Shader> programs_;
+  std::unordered_map<std::string, std::string> files_;
+  size_t compiled_n_ = 0;
+  size_t restored_n_ = 0;
+  size_t shared_n_ = 0;
+};
@@ -4,64 +4,85 @@
 
 #include <stdexcept>
 
+Shape::Shape(World &world,
+             Geometry::Type type,
+             const glm::vec3 &pos,
+             const glm::vec3 &dims) : world_(&world),
+                                      entity_(world.create(type, pos, dims))
+{
+}
+
+Shape::~Shape()
+{
+  world_->destroy(entity_);
+}
+
 glm::vec3 Shape::get_pos() const
 {
-  return state_acc_.get().p;
+  return world_->get_transforms().get(entity_).p;
 }
 
 void Shape::set_pos(const glm::vec3 &pos)
 {
-  state_acc_.get().p = pos;
+  world_->get_transforms().get(entity_).p = pos;
 }
 
 glm::vec3 Shape::get_vel() const
 {
-  return state_acc_.get().v;
+  return world_->get_velocities().get(entity_).v;
 }
 
 void Shape::set_vel(const glm::vec3 &v)
 {
-  state_acc_.get().v = v;
+  world_->get_velocities().get(entity_).v = v;
 }
 
 glm::vec3 Shape::get_angular_vel() const
 {
-  return state_acc_.get().angular_vel;
+  return world_->get_velocities().get(entity_).angular_vel;
 }
 
 void Shape::set_angular_vel(const glm::vec3 &w)
 {
-  state_acc_.get().angular_vel = w;
+  world_->get_velocities().get(entity_).angular_vel = w;
 }
 
 glm::quat Shape::get_orientation() const
 {
-  return state_acc_.get().orientation;
+  return world_->get_transforms().get(entity_).orientation;
 }
 
 void Shape::set_orientation(const glm::quat &q)
 {
-  state_acc_.get().orientation = q;
+  world_->get_transforms().get(entity_).orientation = q;
 }
 
 glm::vec3 Shape::get_dims() const
 {
-  return dims_;
+  return world_->get_geometries().get(entity_).dims;
+}
+
+float Shape::get_elasticity() const
+{
+  return world_->get_materials().get(entity_).elasticity;
 }
 
 void Shape::add_renderable(Renderable r)
 {
-  r_ = r;
+  if (Renderable *renderable = world_->get_renderables().find(entity_))
+    *renderable = r;
+  else
+    world_->get_renderables().add(entity_, r);
 }
 
 void Shape::add_collidable(float mass)
 {
-  c_ = create_collidable(mass);
+  world_->add_collidable(entity_, mass);
 }
 
 bool Shape::has_collidable() const
 {
-  return c_.has_value();
+  return world_->get_collidables().has(entity_);
 }
 
 Collidable &Shape::get_collidable()
@@ -71,7 +92,7 @@ Collidable &Shape::get_collidable()
     throw std::runtime_error("no collidable");
   }
 
-  return c_.value();
+  return world_->get_collidables().get(entity_);
 }
 
 Collidable Shape::get_collidable() const
@@ -81,19 +102,13 @@ Collidable Shape::get_collidable() const
     throw std::runtime_error("no collidable");
   }
 
-  return c_.value();
+  return world_->get_collidables().get(entity_);
 }
 
 void Shape::update_model_if_renderable(const glm::vec3 &dims)
 {
-  if (r_.has_value())
+  if (Renderable *renderable = world_->get_renderables().find(entity_))
   {
-    glm::mat4 model_trans(1.f);
-
-    model_trans = glm::translate(model_trans,
-                                 get_pos());
-    model_trans *= glm::toMat4(get_orientation());
-    model_trans = glm::scale(model_trans, dims);
-    r_.value().update_model_transformation(model_trans);
+    renderable->update_pose(get_pos(), get_orientation(), dims);
   }
 }
@@ -3,27 +3,33 @@
 #include "gl_incs.h"
 #include "Renderable.h"
 #include "Collidable.h"
-#include "State.h"
-
-#include <optional>
+#include "World.h"
 
+// a handle onto an entity of a World, which it creates and destroys with itself.
 class Shape
 {
 public:
-  Shape(Accessor<State> state_acc,
-        glm::vec3 dims) : state_acc_(state_acc),
-                          dims_(dims) {}
+  Shape(World &world,
+        Geometry::Type type,
+        const glm::vec3 &pos,
+        const glm::vec3 &dims);
+  ~Shape();
+  Shape(const Shape &) = delete;
+  Shape &operator=(const Shape &) = delete;
 
 public:
   glm::vec3 get_pos() const;
-  virtual void set_pos(const glm::vec3 &pos);
+  void set_pos(const glm::vec3 &pos);
   glm::quat get_orientation() const;
-  virtual void set_orientation(const glm::quat &q);
+  void set_orientation(const glm::quat &q);
   glm::vec3 get_vel() const;
-  virtual void set_vel(const glm::vec3 &v);
+  void set_vel(const glm::vec3 &v);
   glm::vec3 get_angular_vel() const;
-  virtual void set_angular_vel(const glm::vec3 &w);
+  void set_angular_vel(const glm::vec3 &w);
   glm::vec3 get_dims() const;
+  float get_elasticity() const;
+  Entity get_entity() const { return entity_; }
+  World &get_world() const { return *world_; }
 
   void set_initial_vel(const glm::vec3 &v)
   {
@@ -43,11 +49,6 @@ public:
   void update_model_if_renderable(const glm::vec3 &dims);
 
 private:
-  virtual Collidable create_collidable(float mass) const = 0;
-
-private:
-  std::optional<Renderable> r_;
-  std::optional<Collidable> c_;
-  Accessor<State> state_acc_;
-  glm::vec3 dims_;
+  World *world_;
+  Entity entity_;
 };
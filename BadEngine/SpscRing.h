@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Bounded lock-free queue for exactly one producer and one consumer thread.
+ * One slot is kept empty to tell full from empty, so capacity() is size - 1.
+ */
+template <typename T>
+class SpscRing
+{
+public:
+  explicit SpscRing(size_t capacity) : slots_(capacity + 1) {}
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+public:
+  // producer only, false when full.
+  bool try_push(const T &value)
+  {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next = increment(tail);
+
+    if (next == head_.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    slots_[tail] = value;
+    tail_.store(next, std::memory_order_release);
+
+    return true;
+  }
+
+  // consumer only, false when empty.
+  bool try_pop(T &value)
+  {
+    const size_t head = head_.load(std::memory_order_relaxed);
+
+    if (head == tail_.load(std::memory_order_acquire))
+    {
+      return false;
+    }
+
+    value = slots_[head];
+    head_.store(increment(head), std::memory_order_release);
+
+    return true;
+  }
+
+  bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+  size_t capacity() const { return slots_.size() - 1; }
+
+private:
+  size_t increment(size_t idx) const { return (idx + 1 == slots_.size()) ? 0 : idx + 1; }
+
+private:
+  std::vector<T> slots_;
+  // on separate cache lines, the two threads each write one of them.
+  alignas(64) std::atomic<size_t> head_{ 0 };
+  alignas(64) std::atomic<size_t> tail_{ 0 };
+};
@@ -0,0 +1,154 @@
+#include "StreamBuffer.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// keep section offsets friendly to any attribute layout.
+static inline constexpr size_t MIN_SECTION_ALIGNMENT = 256;
+
+// sections of uniform streams are bound with glBindBufferRange(), which needs the driver's offset alignment.
+static size_t get_section_alignment()
+{
+  GLint uniform_alignment = 0;
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+
+  return std::max<size_t>(MIN_SECTION_ALIGNMENT, (size_t)std::max(uniform_alignment, 0));
+}
+
+static size_t align_up(size_t size, size_t alignment)
+{
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+StreamBuffer::StreamBuffer(GLenum target,
+                           size_t section_size,
+                           bool allow_persistent) : target_(target),
+                                                    persistent_(allow_persistent && GLEW_ARB_buffer_storage)
+{
+  allocate(section_size);
+}
+
+StreamBuffer::~StreamBuffer()
+{
+  release();
+}
+
+void StreamBuffer::allocate(size_t section_size)
+{
+  section_size_ = align_up(std::max<size_t>(section_size, 1), get_section_alignment());
+  section_ = 0;
+
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(target_, buffer_);
+
+  if (persistent_)
+  {
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr total_size = static_cast<GLsizeiptr>(section_size_ * SECTIONS_N);
+
+    glBufferStorage(target_, total_size, NULL, flags);
+    mapped_ = static_cast<char *>(glMapBufferRange(target_, 0, total_size, flags));
+
+    if (!mapped_)
+    {
+      throw std::runtime_error("Cannot map stream buffer.");
+    }
+  }
+  else
+  {
+    glBufferData(target_, static_cast<GLsizeiptr>(section_size_), NULL, GL_STREAM_DRAW);
+    staging_.resize(section_size_);
+  }
+}
+
+void StreamBuffer::release()
+{
+  for (GLsync &f : fences_)
+  {
+    if (f)
+    {
+      glDeleteSync(f);
+      f = 0;
+    }
+  }
+
+  if (buffer_)
+  {
+    if (mapped_)
+    {
+      glBindBuffer(target_, buffer_);
+      glUnmapBuffer(target_);
+      mapped_ = nullptr;
+    }
+
+    // the driver keeps the storage alive until pending draws that read it are done.
+    glDeleteBuffers(1, &buffer_);
+    buffer_ = 0;
+  }
+}
+
+void StreamBuffer::wait_for_section(size_t section)
+{
+  GLsync &f = fences_[section];
+
+  if (!f)
+  {
+    return;
+  }
+
+  static constexpr GLuint64 ONE_SECOND = 1000000000;
+  GLenum res = glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, ONE_SECOND);
+
+  while (res == GL_TIMEOUT_EXPIRED)
+  {
+    res = glClientWaitSync(f, 0, ONE_SECOND);
+  }
+
+  glDeleteSync(f);
+  f = 0;
+}
+
+void *StreamBuffer::begin(size_t size)
+{
+  if (size > section_size_)
+  {
+    release();
+    allocate(std::max(size, 2 * section_size_));
+  }
+
+  write_size_ = size;
+
+  if (!persistent_)
+  {
+    return staging_.data();
+  }
+
+  section_ = (section_ + 1) % SECTIONS_N;
+  wait_for_section(section_);
+
+  return mapped_ + section_ * section_size_;
+}
+
+size_t StreamBuffer::end()
+{
+  if (persistent_)
+  {
+    // coherent mapping, nothing to flush.
+    return section_ * section_size_;
+  }
+
+  glBindBuffer(target_, buffer_);
+  // orphan the old storage so we don't wait for draws still reading it.
+  glBufferData(target_, static_cast<GLsizeiptr>(section_size_), NULL, GL_STREAM_DRAW);
+  glBufferSubData(target_, 0, static_cast<GLsizeiptr>(write_size_), staging_.data());
+
+  return 0;
+}
+
+void StreamBuffer::fence()
+{
+  if (persistent_)
+  {
+    fences_[section_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+}
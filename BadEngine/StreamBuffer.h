@@ -0,0 +1,56 @@
+#pragma once
+
+#include "gl_incs.h"
+
+#include <vector>
+
+/**
+ * A buffer object for data that is rewritten every frame.
+ *
+ * With ARB_buffer_storage the buffer is persistently and coherently mapped and
+ * split into SECTIONS_N sections. Each frame writes to the next section, so the
+ * CPU never touches memory the GPU may still be reading; a fence per section
+ * guards against running more than SECTIONS_N frames ahead.
+ * Without it, writes go to a CPU-side staging area that is uploaded by orphaning
+ * the buffer and calling glBufferSubData.
+ *
+ * Usage per frame:
+ *   void *dst = stream.begin(size);  // write up to size bytes to dst
+ *   size_t offset = stream.end();     // the data now lives at [offset, offset + size)
+ *   ... issue draws reading from stream.id() at offset ...
+ *   stream.fence();
+ */
+class StreamBuffer
+{
+public:
+  StreamBuffer(GLenum target, size_t section_size, bool allow_persistent = true);
+  ~StreamBuffer();
+  StreamBuffer(const StreamBuffer &) = delete;
+  StreamBuffer &operator=(const StreamBuffer &) = delete;
+
+public:
+  void *begin(size_t size);
+  size_t end();
+  void fence();
+
+  GLuint id() const { return buffer_; }
+  bool is_persistent() const { return persistent_; }
+
+private:
+  void allocate(size_t section_size);
+  void release();
+  void wait_for_section(size_t section);
+
+private:
+  static inline constexpr size_t SECTIONS_N = 3;
+
+  const GLenum target_;
+  const bool persistent_;
+  GLuint buffer_ = 0;
+  size_t section_size_ = 0;
+  size_t section_ = 0;
+  size_t write_size_ = 0;
+  char *mapped_ = nullptr;
+  GLsync fences_[SECTIONS_N] = { 0 };
+  std::vector<char> staging_;
+};
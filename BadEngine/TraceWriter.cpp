@@ -0,0 +1,147 @@
+#include "TraceWriter.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+TraceWriter::TraceWriter(const std::string &path) : file_(path, std::ios::binary)
+{
+  if (!file_)
+  {
+    return;
+  }
+
+  file_ << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+  thread_ = std::thread(&TraceWriter::write_loop, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+  finish();
+}
+
+void TraceWriter::submit(std::vector<TraceEvent> &&events)
+{
+  if (events.empty() || !thread_.joinable())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(events));
+  }
+  cv_.notify_one();
+}
+
+void TraceWriter::finish()
+{
+  if (!thread_.joinable())
+  {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+  }
+  cv_.notify_one();
+  thread_.join();
+
+  file_ << "\n]}\n";
+  file_.close();
+}
+
+void TraceWriter::write_loop()
+{
+  std::vector<std::vector<TraceEvent>> batches;
+
+  for (;;)
+  {
+    bool done;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return done_ || !queue_.empty(); });
+      batches.swap(queue_);
+      done = done_;
+    }
+
+    for (const auto &batch : batches)
+    {
+      for (const TraceEvent &event : batch)
+      {
+        write(event);
+      }
+    }
+    batches.clear();
+
+    if (done)
+    {
+      return;
+    }
+  }
+}
+
+static void write_escaped(std::ofstream &file, const char *s)
+{
+  for (; *s; ++s)
+  {
+    if (*s == '"' || *s == '\\')
+    {
+      file << '\\';
+    }
+    file << *s;
+  }
+}
+
+void TraceWriter::write(const TraceEvent &event)
+{
+  char buf[160];
+
+  if (named_threads_.insert(event.thread).second)
+  {
+    std::snprintf(buf, sizeof(buf), "%s{\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"name\":\"thread_name\",\"args\":{\"name\":\"thread %u\"}}",
+                  first_ ? "" : ",\n", event.thread, event.thread);
+    file_ << buf;
+    first_ = false;
+  }
+
+  file_ << (first_ ? "" : ",\n") << "{\"name\":\"";
+  write_escaped(file_, event.name);
+  first_ = false;
+
+  // timestamps are in microseconds.
+  double ts = event.start_ns * 1e-3;
+
+  switch (event.type)
+  {
+  case TraceEvent::Type::zone:
+    std::snprintf(buf, sizeof(buf), "\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                  event.thread, ts, event.duration_ns * 1e-3);
+    break;
+  case TraceEvent::Type::counter:
+    // json has no nan or inf.
+    if (std::isfinite(event.value))
+    {
+      std::snprintf(buf, sizeof(buf), "\",\"ph\":\"C\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%g}}",
+                    event.thread, ts, event.value);
+    }
+    else
+    {
+      std::snprintf(buf, sizeof(buf), "\",\"ph\":\"C\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":null}}",
+                    event.thread, ts);
+    }
+    break;
+  default:
+  {
+    // steps and ends bind to the slice that encloses them, like the begin.
+    const char *phase = event.type == TraceEvent::Type::flow_begin ? "s" : (event.type == TraceEvent::Type::flow_step ? "t" : "f");
+    std::snprintf(buf, sizeof(buf), "\",\"ph\":\"%s\",\"cat\":\"flow\",\"bp\":\"e\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"id\":%" PRIu64 "}",
+                  phase, event.thread, ts, event.id);
+  }
+  break;
+  }
+
+  file_ << buf;
+  ++written_n_;
+}
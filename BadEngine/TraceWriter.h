@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+struct TraceEvent
+{
+  enum class Type : uint8_t
+  {
+    zone,
+    counter,
+    flow_begin,
+    flow_step,
+    flow_end,
+  };
+
+  const char *name; // a string literal
+  Type type;
+  uint32_t thread;
+  uint64_t start_ns;
+  uint64_t duration_ns; // zones
+  double value;         // counters
+  uint64_t id;          // flows
+};
+
+/**
+ * Writes events in the Chrome Trace Event JSON format, which chrome://tracing and
+ * ui.perfetto.dev open. submit() only queues a batch, a writer thread formats and
+ * writes it, so the frame that hands over its events doesn't wait for the disk.
+ */
+class TraceWriter
+{
+public:
+  explicit TraceWriter(const std::string &path);
+  ~TraceWriter();
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+public:
+  void submit(std::vector<TraceEvent> &&events);
+  // writes the queued events and closes the file.
+  void finish();
+
+  bool is_open() const { return file_.is_open(); }
+  // after finish().
+  size_t get_written_count() const { return written_n_; }
+
+private:
+  void write_loop();
+  void write(const TraceEvent &event);
+
+private:
+  std::ofstream file_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<std::vector<TraceEvent>> queue_;
+  bool done_ = false;
+  std::thread thread_;
+
+  // writer thread only.
+  std::unordered_set<uint32_t> named_threads_;
+  bool first_ = true;
+  size_t written_n_ = 0;
+};
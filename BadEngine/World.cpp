@@ -0,0 +1,83 @@
+#include "World.h"
+
+#include <stdexcept>
+
+static constexpr float DEFAULT_ELASTICITY = .9f;
+
+Entity World::create(Geometry::Type type, const glm::vec3 &pos, const glm::vec3 &dims)
+{
+  Entity entity;
+  if (free_entities_.empty())
+  {
+    entity = next_entity_++;
+  }
+  else
+  {
+    entity = free_entities_.back();
+    free_entities_.pop_back();
+  }
+
+  transforms_.add(entity, pos, glm::identity<glm::quat>());
+  velocities_.add(entity, glm::vec3(0.f), glm::vec3(0.f));
+  geometries_.add(entity, type, dims);
+  materials_.add(entity, DEFAULT_ELASTICITY);
+
+  return entity;
+}
+
+void World::destroy(Entity entity)
+{
+  transforms_.remove(entity);
+  velocities_.remove(entity);
+  geometries_.remove(entity);
+  materials_.remove(entity);
+  collidables_.remove(entity);
+  renderables_.remove(entity);
+
+  free_entities_.push_back(entity);
+}
+
+Collidable &World::add_collidable(Entity entity, float mass)
+{
+  const Geometry &geometry = geometries_.get(entity);
+  const glm::vec3 &dims = geometry.dims;
+  glm::mat3 IBody;
+  Collidable::Type type;
+
+  switch (geometry.type)
+  {
+  case Geometry::Type::sphere:
+    IBody = glm::identity<glm::mat3>() * (2.f / 5.f) * mass * dims.x * dims.x; // (2/5)*m*r^2
+    type = Collidable::Type::sphere;
+    break;
+  case Geometry::Type::box:
+    IBody = glm::identity<glm::mat3>() * (mass / 12.f);
+    IBody[0][0] = dims.y * dims.y + dims.z * dims.z;
+    IBody[1][1] = dims.x * dims.x + dims.z * dims.z;
+    IBody[2][2] = dims.x * dims.x + dims.y * dims.y;
+    type = Collidable::Type::box;
+    break;
+  default:
+    throw std::runtime_error("not implemented"); // DUDU arrows
+  }
+
+  if (Collidable *collidable = collidables_.find(entity))
+  {
+    *collidable = Collidable(type, mass, IBody);
+    return *collidable;
+  }
+
+  return collidables_.add(entity, type, mass, IBody);
+}
+
+void World::sync_render_instances()
+{
+  const std::vector<Entity> &entities = renderables_.get_entities();
+  std::vector<Renderable> &renderables = renderables_.get_data();
+
+  for (size_t i = 0; i < renderables.size(); ++i)
+  {
+    const Transform &transform = transforms_.get(entities[i]);
+    renderables[i].update_pose(transform.p, transform.orientation, geometries_.get(entities[i]).dims);
+  }
+}
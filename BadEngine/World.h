@@ -0,0 +1,85 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "ComponentTable.h"
+#include "Collidable.h"
+#include "Renderable.h"
+
+#include <vector>
+
+struct Transform
+{
+  glm::vec3 p;
+  glm::quat orientation;
+};
+
+struct Velocity
+{
+  glm::vec3 v;
+  glm::vec3 angular_vel;
+};
+
+struct Geometry
+{
+  enum class Type
+  {
+    sphere = 0,
+    box,
+    arrow,
+  };
+
+  Type type;
+  glm::vec3 dims; // the radius in all three for spheres
+};
+
+// colours are per renderable type, see BadEngine::RenderData.
+struct Material
+{
+  float elasticity;
+};
+
+/**
+ * Entities are ids, their data lives in one dense table per component. Every entity has a
+ * transform, a velocity, a geometry and a material, bodies also a collidable (the dynamics:
+ * momenta, inverse mass and inertia) and drawn ones a renderable. Systems iterate only the
+ * tables they need, Shape and its subclasses are handles onto one entity.
+ */
+class World
+{
+public:
+  Entity create(Geometry::Type type, const glm::vec3 &pos, const glm::vec3 &dims);
+  // removes all of the entity's components, its id is reused.
+  void destroy(Entity entity);
+  // the inertia comes from the geometry, non-positive mass makes the body static. throws
+  // std::runtime_error for geometries without one.
+  Collidable &add_collidable(Entity entity, float mass);
+  size_t size() const { return transforms_.size(); }
+
+  // writes the pose of every renderable from its transform and geometry.
+  void sync_render_instances();
+
+public:
+  ComponentTable<Transform> &get_transforms() { return transforms_; }
+  ComponentTable<Velocity> &get_velocities() { return velocities_; }
+  ComponentTable<Geometry> &get_geometries() { return geometries_; }
+  ComponentTable<Material> &get_materials() { return materials_; }
+  ComponentTable<Collidable> &get_collidables() { return collidables_; }
+  ComponentTable<Renderable> &get_renderables() { return renderables_; }
+  const ComponentTable<Transform> &get_transforms() const { return transforms_; }
+  const ComponentTable<Velocity> &get_velocities() const { return velocities_; }
+  const ComponentTable<Geometry> &get_geometries() const { return geometries_; }
+  const ComponentTable<Material> &get_materials() const { return materials_; }
+  const ComponentTable<Collidable> &get_collidables() const { return collidables_; }
+  const ComponentTable<Renderable> &get_renderables() const { return renderables_; }
+
+private:
+  ComponentTable<Transform> transforms_;
+  ComponentTable<Velocity> velocities_;
+  ComponentTable<Geometry> geometries_;
+  ComponentTable<Material> materials_;
+  ComponentTable<Collidable> collidables_;
+  ComponentTable<Renderable> renderables_;
+
+  std::vector<Entity> free_entities_;
+  Entity next_entity_ = 0;
+};
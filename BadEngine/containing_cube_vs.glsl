@@ -1,10 +1,9 @@
 #version 400
+#include "frame_uniforms.glsl"
 
 layout(location = 0) in vec3 pos;
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 void main()
 {
@@ -0,0 +1,9 @@
+// Per-frame constants shared by all programs, see FrameUniforms in BadEngine.h.
+layout(std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    vec4 eye_pos;   // xyz
+    vec4 light_pos; // xyz
+    vec4 material_colors[8]; // rgb, MAX_MATERIALS in BadEngine.h
+};
\ No newline at end of file
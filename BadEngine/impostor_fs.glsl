@@ -0,0 +1,33 @@
+#version 400
+#include "frame_uniforms.glsl"
+#include "phong.glsl"
+
+out vec4 frag_colour;
+
+in vec3 frag_pos;
+flat in vec3 sphere_center;
+flat in float sphere_radius;
+flat in vec3 object_color;
+
+void main()
+{
+    // intersect the eye ray through this fragment with the sphere.
+    vec3 ray_dir=normalize(frag_pos - eye_pos.xyz);
+    vec3 to_center=sphere_center - eye_pos.xyz;
+    float b=dot(ray_dir, to_center);
+    float c=dot(to_center, to_center) - sphere_radius * sphere_radius;
+    float disc=b * b - c;
+
+    if (disc < 0.)
+    {
+        discard;
+    }
+
+    vec3 hit_pos=eye_pos.xyz + (b - sqrt(disc)) * ray_dir;
+
+    vec4 clip_pos=projection * view * vec4(hit_pos, 1.0);
+    float ndc_depth=clip_pos.z / clip_pos.w;
+    gl_FragDepth=(gl_DepthRange.diff * ndc_depth + gl_DepthRange.near + gl_DepthRange.far) * .5;
+
+    frag_colour=vec4(phong(hit_pos, (hit_pos - sphere_center) / sphere_radius, object_color), 1.);
+}
\ No newline at end of file
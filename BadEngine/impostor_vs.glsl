@@ -0,0 +1,42 @@
+#version 400
+#include "frame_uniforms.glsl"
+
+// quad corners, (-1,-1) to (1,1), see BadEngine::init_impostor_program().
+layout(location=0) in vec3 pos;
+
+// Per instance, see InstancePose. The orientation is irrelevant for a sphere.
+layout(location=3) in vec3 inst_pos;
+layout(location=5) in vec3 inst_scale;
+layout(location=6) in uint inst_material;
+
+out vec3 frag_pos; // on the quad, world space
+flat out vec3 sphere_center;
+flat out float sphere_radius;
+flat out vec3 object_color;
+
+void main()
+{
+    vec2 corner=pos.xy;
+
+    // the unit sphere mesh is scaled by the radius.
+    float radius=inst_scale.x;
+    vec3 to_center=inst_pos - eye_pos.xyz;
+    float dist=max(length(to_center), radius * 1.001);
+    // not to_center / dist, dist is clamped inside the sphere.
+    vec3 dir=normalize(to_center);
+
+    // a quad through the center, facing the eye.
+    vec3 helper=abs(dir.y) > .99 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right=normalize(cross(dir, helper));
+    vec3 up=cross(right, dir);
+
+    // the cone of rays from the eye tangent to the sphere cuts that plane at this radius.
+    float half_size=radius * dist / sqrt(dist * dist - radius * radius);
+
+    frag_pos=inst_pos + (corner.x * right + corner.y * up) * half_size;
+    sphere_center=inst_pos;
+    sphere_radius=radius;
+    object_color=material_colors[inst_material].rgb;
+
+    gl_Position=projection * view * vec4(frag_pos, 1.0);
+}
\ No newline at end of file
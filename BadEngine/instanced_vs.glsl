@@ -0,0 +1,54 @@
+#version 400
+#include "frame_uniforms.glsl"
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 in_normal;
+
+// Per instance, see InstancePose.
+layout(location=3) in vec3 inst_pos;
+layout(location=4) in vec4 inst_orientation; // quaternion, (x, y, z, w)
+layout(location=5) in vec3 inst_scale;
+layout(location=6) in uint inst_material;
+
+out vec3 frag_normal;
+out vec3 frag_pos;
+flat out vec3 object_color;
+
+mat3 quat_to_mat3(vec4 q)
+{
+    vec3 q2=q.xyz + q.xyz;
+    float xx=q.x * q2.x, yy=q.y * q2.y, zz=q.z * q2.z;
+    float xy=q.x * q2.y, xz=q.x * q2.z, yz=q.y * q2.z;
+    float wx=q.w * q2.x, wy=q.w * q2.y, wz=q.w * q2.z;
+
+    // column major
+    return mat3(1.0 - (yy + zz), xy + wz, xz - wy,
+                xy - wz, 1.0 - (xx + zz), yz + wx,
+                xz + wy, yz - wx, 1.0 - (xx + yy));
+}
+
+void main()
+{
+    mat3 rotation=quat_to_mat3(inst_orientation);
+
+    // model = translate * rotate * scale
+    mat4 model=mat4(vec4(rotation[0] * inst_scale.x, 0.0),
+                    vec4(rotation[1] * inst_scale.y, 0.0),
+                    vec4(rotation[2] * inst_scale.z, 0.0),
+                    vec4(inst_pos, 1.0));
+
+    vec4 world_pos=model * vec4(pos, 1.0);
+
+#ifdef UNIFORM_SCALE
+    // rigid or uniformly scaled, the fragment shader normalizes.
+    frag_normal=rotation * in_normal;
+#else
+    // inverse transpose of rotate * scale is rotate * inverse(scale).
+    frag_normal=mat3(rotation[0] / inst_scale.x,
+                     rotation[1] / inst_scale.y,
+                     rotation[2] / inst_scale.z) * in_normal;
+#endif
+    frag_pos=world_pos.xyz;
+    object_color=material_colors[inst_material].rgb;
+    gl_Position=projection * view * world_pos;
+}
\ No newline at end of file
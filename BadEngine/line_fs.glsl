@@ -0,0 +1,10 @@
+#version 400
+
+in vec3 frag_color;
+
+out vec4 frag_colour;
+
+void main()
+{
+    frag_colour=vec4(frag_color, 1.);
+}
\ No newline at end of file
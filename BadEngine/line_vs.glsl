@@ -0,0 +1,13 @@
+#version 400
+#include "frame_uniforms.glsl"
+
+layout(location=0) in vec3 pos;
+layout(location=1) in vec3 color;
+
+out vec3 frag_color;
+
+void main()
+{
+    frag_color=color;
+    gl_Position=projection * view * vec4(pos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#version 400
+
+layout(location=0) in vec2 pos;
+layout(location=1) in vec3 color;
+
+out vec3 frag_color;
+
+void main()
+{
+    frag_color=color;
+    gl_Position=vec4(pos, 0.0, 1.0);
+}
\ No newline at end of file
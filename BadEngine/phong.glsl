@@ -0,0 +1,22 @@
+// Expects frame_uniforms.glsl to be included first.
+vec3 phong(vec3 pos, vec3 normal, vec3 object_color)
+{
+    // ambience
+    vec3 light_color=vec3(1., 1., 1.);
+
+    float ambience_strength=0.1;
+    vec3 ambience=ambience_strength * light_color;
+
+    // diffuse
+    vec3 to_light=normalize(light_pos.xyz - pos);
+    float diffuse_value=max(0., dot(to_light, normal));
+    vec3 diffuse=light_color * diffuse_value;
+
+    // specular
+    vec3 reflect_light_to_eye=reflect(-to_light, normal);
+    float specular_param=.5;
+    float specular_value=pow(max(0., dot(reflect_light_to_eye, normalize(eye_pos.xyz - pos))), 32);
+    vec3 specular=light_color * specular_value * specular_param;
+
+    return (ambience + diffuse + specular) * object_color;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "gl_incs.h"
 
+#include <chrono>
 #include <fstream>
 
 using namespace std;
@@ -56,4 +57,23 @@ string utility::read_file(const char *file_path)
 
   file_stream.close();
   return content;
-}
\ No newline at end of file
+}
+
+double utility::get_time()
+{
+  static const auto start = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t utility::hash(const void *data, size_t size, uint64_t hash)
+{
+  const unsigned char *bytes = (const unsigned char *)data;
+  for (size_t i = 0; i < size; ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+
+  return hash;
+}
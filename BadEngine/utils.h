@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace utility
@@ -7,6 +9,10 @@ namespace utility
   void dbg_print(const std::string &msg);
   int r_exit(int code, const std::string &msg = "");
   std::string read_file(const char *file_path);
+  // seconds on a monotonic clock, works without a window unlike glfwGetTime().
+  double get_time();
+  // FNV-1a, pass the previous result as hash to chain blocks.
+  uint64_t hash(const void *data, size_t size, uint64_t hash = 14695981039346656037ull);
   static inline constexpr double PI = 3.14159265359;
 };
 
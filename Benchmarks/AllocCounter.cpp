@@ -0,0 +1,13 @@
+#include "AllocCounter.h"
+
+#include "AllocTracker.h"
+
+uint64_t alloc_counter::get_count()
+{
+  return AllocTracker::get_total_counts().allocs;
+}
+
+void alloc_counter::report(benchmark::State &state, uint64_t count_before)
+{
+  state.counters["allocs/iter"] = benchmark::Counter((double)(get_count() - count_before), benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+/**
+ * Counts calls to the global operator new of the whole process, through BadEngine's
+ * AllocHook.cpp, which this project compiles with BE_TRACK_ALLOCS. Benchmarks take a count before their loop and report the difference.
+ */
+namespace alloc_counter
+{
+  uint64_t get_count();
+
+  // sets the 'allocs/iter' counter from the count taken before the benchmark loop.
+  void report(benchmark::State &state, uint64_t count_before);
+}
@@ -0,0 +1,34 @@
+#include "BenchmarkScene.h"
+
+#include <cmath>
+#include <random>
+
+SphereScene::SphereScene(size_t spheres_n, float density, const glm::vec3 &world_dims, unsigned int seed)
+{
+  static constexpr float PI = 3.14159265f;
+  static constexpr float MASS = 7.f;
+
+  const float world_volume = world_dims.x * world_dims.y * world_dims.z;
+  rad_ = std::cbrt(density * world_volume * 3.f / (4.f * PI * spheres_n));
+
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> vel_dist(-1.f, 1.f);
+  const glm::vec3 half = world_dims / 2.f - glm::vec3(rad_);
+
+  owned_.reserve(spheres_n);
+  spheres_.reserve(spheres_n);
+
+  for (size_t i = 0; i < spheres_n; ++i)
+  {
+    glm::vec3 pos(std::uniform_real_distribution<float>(-half.x, half.x)(rng),
+                  std::uniform_real_distribution<float>(-half.y, half.y)(rng),
+                  std::uniform_real_distribution<float>(-half.z, half.z)(rng));
+
+    auto sphere = std::make_unique<Sphere>(world_, pos.x, pos.y, pos.z, rad_);
+    sphere->add_collidable(MASS);
+    sphere->set_initial_vel(glm::vec3(vel_dist(rng), vel_dist(rng), vel_dist(rng)));
+
+    spheres_.push_back(sphere.get());
+    owned_.push_back(std::move(sphere));
+  }
+}
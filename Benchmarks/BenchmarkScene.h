@@ -0,0 +1,33 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Sphere.h"
+#include "World.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * Spheres with collidables at random positions and velocities inside a world of
+ * world_dims centered at the origin, like the solvers'. No engine or GL context.
+ */
+class SphereScene
+{
+public:
+  // density is the fraction of the world's volume the spheres fill, it sets their radius.
+  SphereScene(size_t spheres_n, float density, const glm::vec3 &world_dims, unsigned int seed = 1);
+  SphereScene(const SphereScene &) = delete;
+  SphereScene &operator=(const SphereScene &) = delete;
+
+public:
+  const std::vector<Sphere *> &get_spheres() const { return spheres_; }
+  float get_radius() const { return rad_; }
+  World &get_world() { return world_; }
+
+private:
+  // declared first, the spheres remove their entities as they go.
+  World world_;
+  std::vector<std::unique_ptr<Sphere>> owned_;
+  std::vector<Sphere *> spheres_;
+  float rad_;
+};
@@ -0,0 +1,4 @@
+#include <benchmark/benchmark.h>
+
+// headless, no window or GL context: every benchmark drives the CFD and BadEngine code directly.
+BENCHMARK_MAIN();
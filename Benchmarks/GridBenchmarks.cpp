@@ -0,0 +1,106 @@
+#include "AllocCounter.h"
+#include "BenchmarkScene.h"
+#include "CollisionSolver.h"
+#include "Particle.h"
+#include "SphereGridMap.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+// the world of the solvers, see CollisionSolver.
+static const glm::vec3 WORLD_DIMS(5.f);
+
+// args: spheres, density in percent of the world's volume.
+static void grid_args(benchmark::internal::Benchmark *b)
+{
+  b->ArgNames({ "spheres", "density%" })->ArgsProduct({ { 1 << 10, 1 << 13, 1 << 15, 1 << 16, 1 << 18, 1 << 20 }, { 1, 10, 30 } });
+}
+
+static void BM_GridRebuild(benchmark::State &state)
+{
+  SphereScene scene((size_t)state.range(0), state.range(1) / 100.f, WORLD_DIMS);
+  SphereGridMap map(scene.get_radius(), WORLD_DIMS);
+  std::vector<Particle> particles;
+  particles::gather(scene.get_spheres(), particles);
+
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    map.update_map(particles);
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GridRebuild)->Apply(grid_args)->Unit(benchmark::kMicrosecond);
+
+static void BM_GridNeighbourQuery(benchmark::State &state)
+{
+  SphereScene scene((size_t)state.range(0), state.range(1) / 100.f, WORLD_DIMS);
+  SphereGridMap map(scene.get_radius(), WORLD_DIMS);
+  std::vector<Particle> particles;
+  particles::gather(scene.get_spheres(), particles);
+  map.update_map(particles);
+
+  size_t neighbours_n = 0;
+  std::vector<uint32_t> nbs;
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    for (uint32_t i = 0; i < (uint32_t)particles.size(); ++i)
+    {
+      nbs.clear();
+      map.get_neighbours(i, particles[i].p, nbs);
+      neighbours_n += nbs.size();
+    }
+    benchmark::DoNotOptimize(neighbours_n);
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["neighbours/sphere"] = (double)neighbours_n / (state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GridNeighbourQuery)->Apply(grid_args)->Unit(benchmark::kMicrosecond);
+
+static void solve(benchmark::State &state, sphere_coll_alg alg)
+{
+  SphereScene scene((size_t)state.range(0), state.range(1) / 100.f, WORLD_DIMS);
+  std::unique_ptr<CollisionSolver> solver(SolverFactory::create(alg, scene.get_radius()));
+  const std::vector<Sphere *> &spheres = scene.get_spheres();
+
+  std::vector<glm::vec3> initial_vel(spheres.size());
+  for (size_t i = 0; i < spheres.size(); ++i)
+  {
+    initial_vel[i] = spheres[i]->get_vel();
+  }
+
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    // solving separates the pairs it resolves, restore the scene's velocities so every iteration solves them again.
+    state.PauseTiming();
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+      spheres[i]->set_vel(initial_vel[i]);
+    }
+    state.ResumeTiming();
+
+    solver->handle_collisions(spheres);
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_GridSolve(benchmark::State &state)
+{
+  solve(state, sphere_coll_alg::grid);
+}
+BENCHMARK(BM_GridSolve)->Apply(grid_args)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_NaiveSolve(benchmark::State &state)
+{
+  solve(state, sphere_coll_alg::naive);
+}
+// quadratic, beyond 32k spheres a single iteration takes seconds. so only the grid's sizes up
+// to 32k are compared, the larger ones up to 1M are measured for the grid alone.
+BENCHMARK(BM_NaiveSolve)->ArgNames({ "spheres", "density%" })->ArgsProduct({ { 1 << 10, 1 << 13, 1 << 15 }, { 1, 10, 30 } })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,45 @@
+#include "AllocCounter.h"
+#include "BenchmarkScene.h"
+#include "Integrator.h"
+
+#include <benchmark/benchmark.h>
+
+static void BM_Integrate(benchmark::State &state)
+{
+  static constexpr float H = .001f;
+  static constexpr float DAMPING = .09f;
+  static const glm::vec3 GRAVITY_ACC(0.f, -9.8f, 0.f);
+
+  SphereScene scene((size_t)state.range(0), .1f, glm::vec3(5.f));
+
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    for (Sphere *sphere : scene.get_spheres())
+    {
+      integrator::integrate_shape(*sphere, H, GRAVITY_ACC, glm::vec3(0.f), DAMPING);
+    }
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Integrate)->ArgName("bodies")->RangeMultiplier(8)->Range(64, 1 << 18);
+
+// the same through the world's tables, without the shape handles.
+static void BM_IntegrateBodies(benchmark::State &state)
+{
+  static constexpr float H = .001f;
+  static constexpr float DAMPING = .09f;
+  static const glm::vec3 GRAVITY(0.f, -9.8f, 0.f);
+
+  SphereScene scene((size_t)state.range(0), .1f, glm::vec3(5.f));
+
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    integrator::integrate_bodies(scene.get_world(), H, GRAVITY, glm::vec3(0.f), DAMPING);
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_IntegrateBodies)->ArgName("bodies")->RangeMultiplier(8)->Range(64, 1 << 18);
@@ -0,0 +1,74 @@
+#include "AllocCounter.h"
+#include "OBJParser.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// writes a uv sphere of about triangles_n triangles in the v/vn/f a//b form OBJParser reads.
+static std::string write_sphere_obj(size_t triangles_n)
+{
+  static constexpr float PI = 3.14159265f;
+
+  const size_t segments = (size_t)std::sqrt(triangles_n / 2.f) + 3;
+  const size_t rings = segments;
+
+  std::string path = (std::filesystem::temp_directory_path() / ("bench_sphere_" + std::to_string(triangles_n) + ".obj")).string();
+  std::ofstream obj(path);
+
+  for (size_t r = 0; r <= rings; ++r)
+  {
+    float theta = PI * r / rings;
+    for (size_t s = 0; s <= segments; ++s)
+    {
+      float phi = 2.f * PI * s / segments;
+      float x = std::sin(theta) * std::cos(phi), y = std::cos(theta), z = std::sin(theta) * std::sin(phi);
+
+      obj << "v " << x << " " << y << " " << z << "\n";
+      obj << "vn " << x << " " << y << " " << z << "\n";
+    }
+  }
+
+  for (size_t r = 0; r < rings; ++r)
+  {
+    for (size_t s = 0; s < segments; ++s)
+    {
+      // 1-based, normals share the vertices' indices.
+      size_t a = r * (segments + 1) + s + 1, b = a + segments + 1;
+      obj << "f " << a << "//" << a << " " << b << "//" << b << " " << a + 1 << "//" << a + 1 << "\n";
+      obj << "f " << a + 1 << "//" << a + 1 << " " << b << "//" << b << " " << b + 1 << "//" << b + 1 << "\n";
+    }
+  }
+
+  return path;
+}
+
+static void BM_OBJParse(benchmark::State &state)
+{
+  const std::string path = write_sphere_obj((size_t)state.range(0));
+  const size_t file_size = (size_t)std::filesystem::file_size(path);
+
+  size_t faces_n = 0;
+  float acmr_before = 0.f, acmr_after = 0.f;
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    OBJParser parser;
+    parser.parse(path);
+    faces_n = parser.get_indices().size() / 3;
+    acmr_before = parser.get_acmr_before();
+    acmr_after = parser.get_acmr_after();
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * faces_n);
+  state.SetBytesProcessed(state.iterations() * file_size);
+  state.counters["acmr_before"] = acmr_before;
+  state.counters["acmr_after"] = acmr_after;
+
+  std::remove(path.c_str());
+}
+BENCHMARK(BM_OBJParse)->ArgName("triangles")->RangeMultiplier(16)->Range(1 << 10, 1 << 18)->Unit(benchmark::kMillisecond);
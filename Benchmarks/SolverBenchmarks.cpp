@@ -0,0 +1,51 @@
+#include "AllocCounter.h"
+#include "BenchmarkScene.h"
+#include "ImpulseCollisionSolver.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+// pairs of spheres touching along x and moving into each other, one contact each.
+static void BM_ImpulseSolve(benchmark::State &state)
+{
+  const size_t contacts_n = (size_t)state.range(0);
+  SphereScene scene(2 * contacts_n, .1f, glm::vec3(5.f));
+  const std::vector<Sphere *> &spheres = scene.get_spheres();
+  const float rad = scene.get_radius();
+
+  ImpulseCollisionSolver solver(nullptr);
+
+  std::vector<glm::vec3> initial_vel(spheres.size());
+  for (size_t i = 0; i < contacts_n; ++i)
+  {
+    Sphere *s1 = spheres[2 * i];
+    Sphere *s2 = spheres[2 * i + 1];
+
+    s2->set_pos(s1->get_pos() + glm::vec3(2.f * rad, 0.f, 0.f));
+    initial_vel[2 * i] = glm::vec3(1.f, 0.f, 0.f);
+    initial_vel[2 * i + 1] = glm::vec3(-1.f, 0.f, 0.f);
+
+    const glm::vec3 p = s1->get_pos() + glm::vec3(rad, 0.f, 0.f);
+    solver.add_contact(s1, s2, 0.f, glm::vec3(-1.f, 0.f, 0.f), p, p);
+  }
+
+  uint64_t allocs = alloc_counter::get_count();
+  for (auto _ : state)
+  {
+    // solving separates the pairs, restore the approach so every contact is resolved again.
+    state.PauseTiming();
+    for (size_t i = 0; i < spheres.size(); ++i)
+    {
+      spheres[i]->get_collidable().L = glm::vec3(0.f);
+      spheres[i]->set_angular_vel(glm::vec3(0.f));
+      spheres[i]->set_initial_vel(initial_vel[i]);
+    }
+    state.ResumeTiming();
+
+    solver.solve();
+  }
+  alloc_counter::report(state, allocs);
+  state.SetItemsProcessed(state.iterations() * contacts_n);
+}
+BENCHMARK(BM_ImpulseSolve)->ArgName("contacts")->RangeMultiplier(8)->Range(8, 1 << 15);
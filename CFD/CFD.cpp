@@ -1,6 +1,144 @@
 #include <iostream>
 
 #include "Simulator.h"
+#include "ScenarioRunner.h"
+#include "Profiler.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// CFD --scenario <gas|pile|tower|mixed|dam_break> [--seed n] [--steps n] [--spheres n]
+//     [--boxes n] [--out file] [--stats file] [--alloc-free <warm-up steps>]
+static ScenarioRunner::Config parse_scenario_args(int argc, char *argv[])
+{
+  ScenarioRunner::Config config;
+  config.scene = ScenarioRunner::parse_scene(argv[2]);
+
+  for (int i = 3; i < argc; i += 2)
+  {
+    if (i + 1 == argc)
+      throw std::runtime_error(std::string("missing value for ") + argv[i]);
+
+    const char *value = argv[i + 1];
+    if (strcmp(argv[i], "--out") == 0)
+    {
+      config.output_path = value;
+      continue;
+    }
+    if (strcmp(argv[i], "--stats") == 0)
+    {
+      config.stats_path = value;
+      continue;
+    }
+
+    unsigned int n = static_cast<unsigned int>(std::stoul(value));
+    if (strcmp(argv[i], "--seed") == 0)
+      config.seed = n;
+    else if (strcmp(argv[i], "--steps") == 0)
+      config.steps = n;
+    else if (strcmp(argv[i], "--spheres") == 0)
+      config.spheres_n = n;
+    else if (strcmp(argv[i], "--boxes") == 0)
+      config.boxes_n = n;
+    else if (strcmp(argv[i], "--alloc-free") == 0)
+    {
+      config.alloc_free = true;
+      config.alloc_warmup_steps = n;
+    }
+    else
+      throw std::runtime_error(std::string("unknown argument: ") + argv[i]);
+  }
+
+  return config;
+}
+
+static BadEngine::RenderMode parse_render_mode(const std::string &name)
+{
+  if (name == "mesh")
+    return BadEngine::RenderMode::mesh;
+  if (name == "impostor")
+    return BadEngine::RenderMode::impostor;
+
+  throw std::runtime_error("unknown sphere mode: " + name);
+}
+
+// CFD --offscreen <frames> [--scene <gas|pile|tower|mixed|dam_break>] [--seed n] [--spheres n]
+//     [--boxes n] [--capture dir] [--sphere-obj file] [--sphere-mode <mesh|impostor>] draws the
+//     frames without a display, e.g. on CI, and with --capture records them to
+//     dir/offscreen.y4m. --sphere-obj draws the spheres with an obj's unit sphere instead of
+//     the generated lods, --sphere-mode impostor with ray-cast quads.
+static void run_offscreen(int argc, char *argv[])
+{
+  const unsigned int frames_n = static_cast<unsigned int>(std::stoul(argv[2]));
+  Simulator::Scene scene = Simulator::Scene::gas;
+  unsigned int seed = 1;
+  unsigned int spheres_n = 9;
+  unsigned int boxes_n = 9;
+  std::string capture_dir;
+  std::string sphere_obj;
+  BadEngine::RenderMode sphere_mode = BadEngine::RenderMode::mesh;
+
+  for (int i = 3; i < argc; i += 2)
+  {
+    if (i + 1 == argc)
+      throw std::runtime_error(std::string("missing value for ") + argv[i]);
+
+    const char *value = argv[i + 1];
+    if (strcmp(argv[i], "--scene") == 0)
+    {
+      scene = ScenarioRunner::parse_scene(value);
+      continue;
+    }
+    if (strcmp(argv[i], "--capture") == 0)
+    {
+      capture_dir = value;
+      continue;
+    }
+    if (strcmp(argv[i], "--sphere-obj") == 0)
+    {
+      sphere_obj = value;
+      continue;
+    }
+    if (strcmp(argv[i], "--sphere-mode") == 0)
+    {
+      sphere_mode = parse_render_mode(value);
+      continue;
+    }
+
+    unsigned int n = static_cast<unsigned int>(std::stoul(value));
+    if (strcmp(argv[i], "--seed") == 0)
+      seed = n;
+    else if (strcmp(argv[i], "--spheres") == 0)
+      spheres_n = n;
+    else if (strcmp(argv[i], "--boxes") == 0)
+      boxes_n = n;
+    else
+      throw std::runtime_error(std::string("unknown argument: ") + argv[i]);
+  }
+
+  if (frames_n == 0)
+    throw std::runtime_error("--offscreen needs at least one frame");
+
+  Simulator sim(spheres_n, boxes_n, seed);
+  if (!sphere_obj.empty())
+    sim.get_engine().set_sphere_mesh(sphere_obj);
+  sim.init(scene, false, BadEngine::Backend::offscreen);
+  sim.get_engine().set_render_mode(BadEngine::RenderableType::sphere, sphere_mode);
+
+  if (!capture_dir.empty())
+  {
+    FrameCapture::Config config;
+    config.output_dir = capture_dir;
+    config.name = "offscreen";
+    // every frame, the run doesn't have to keep up with a display.
+    config.overflow = FrameCapture::OverflowPolicy::block;
+    sim.get_engine().start_capture(config);
+  }
+
+  sim.run(frames_n);
+  sim.get_engine().stop_capture();
+}
 
 int main(int argc, char *argv[])
 {
@@ -8,10 +146,23 @@ int main(int argc, char *argv[])
 
   try
   {
+    if (argc >= 3 && strcmp(argv[1], "--scenario") == 0)
+    {
+      ScenarioRunner runner(parse_scenario_args(argc, argv));
+      runner.run();
+      return 0;
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "--offscreen") == 0)
+    {
+      run_offscreen(argc, argv);
+      return 0;
+    }
+
     unsigned int spheres_n = 9;
     unsigned int boxes_n = 9;
 
-    if (argc == 2)
+    if (argc >= 2)
     {
       int n = atoi(argv[1]);
       if (n > 0)
@@ -22,6 +173,17 @@ int main(int argc, char *argv[])
 
     sim.init();
 
+#ifdef BE_PROFILE
+    // CFD <spheres> <first frame> <frames> traces that window to trace.json.
+    if (argc == 4)
+    {
+      int first_frame = atoi(argv[2]);
+      int frames_n = atoi(argv[3]);
+      if (first_frame >= 0 && frames_n > 0)
+        Profiler::get().start_trace("trace.json", frames_n, first_frame);
+    }
+#endif
+
     sim.run();
   }
   catch (const std::exception &error)
@@ -1,6 +1,8 @@
 #include "CollisionSolver.h"
 
 #include <glm/gtx/norm.hpp>
+#include <Profiler.h>
+#include "SimStats.h"
 #include <tbb/parallel_for.h>
 #include <thread>
 #include <mutex>
@@ -8,78 +10,72 @@
 /*******************************************************************************
  * class CollisionSolver Implementation
  */
-void CollisionSolver::solve_collided_spheres(Sphere *s1,
-                                             Sphere *s2,
+void CollisionSolver::solve_collided_spheres(Particle &p1,
+                                             Particle &p2,
                                              float elasticity)
 {
-  bool should_update = false;
-
-  {
-    std::scoped_lock lock(s1->in_collision_m_, s2->in_collision_m_);
-
-    s1->colliders_.insert(s2);
-    s2->colliders_.insert(s1);
-    should_update = true;
-  }
+  glm::vec3 n = glm::normalize(p1.p - p2.p);
+  glm::vec3 vrel = p1.v - p2.v;
+  float verl_scl = glm::dot(vrel, n);
 
-  if (should_update)
+  if (verl_scl < 0)
   {
-    glm::vec3 n = glm::normalize(s1->get_pos() - s2->get_pos());
-    glm::vec3 vrel = s1->get_vel() - s2->get_vel();
-    float verl_scl = glm::dot(vrel, n);
-
-    if (verl_scl < 0)
-    {
-      float imp_nom = -1 * (1 + elasticity) * verl_scl;
-      float imp_denom = (1 / s1->mass) + (1 / s2->mass);
-      float imp = imp_nom / imp_denom;
+    float imp_nom = -1 * (1 + elasticity) * verl_scl;
+    float imp_denom = p1.inv_mass + p2.inv_mass;
+    float imp = imp_nom / imp_denom;
 
-      s1->set_vel(s1->get_vel() + (imp / s1->mass) * n);
-      s2->set_vel(s2->get_vel() - (imp / s2->mass) * n);
-    }
+    p1.v += (imp * p1.inv_mass) * n;
+    p2.v -= (imp * p2.inv_mass) * n;
   }
 }
 
-void CollisionSolver::handle_world_collision2_coord(Sphere *s,
+void CollisionSolver::handle_world_collision2_coord(Particle &p,
+                                                    const Sphere *s,
                                                     float glm::vec3::*coord)
 {
-  if (s->get_pos().*coord - s->rad <= center_.*coord - dims_.*coord / 2 && s->get_vel().*coord < 0)
+  if (p.p.*coord - p.rad <= center_.*coord - dims_.*coord / 2 && p.v.*coord < 0)
   {
-    glm::vec3 v = s->get_vel();
-    v.*coord *= -s->elasticity;
-    s->set_vel(v);
-    //s->pos.*coord = center_.*coord - dims_.*coord / 2 + s->rad;
+    p.v.*coord *= -s->get_elasticity();
+    //p.p.*coord = center_.*coord - dims_.*coord / 2 + p.rad;
   }
 
-  if (s->get_pos().*coord + s->rad >= center_.*coord + dims_.*coord / 2 && s->get_vel().*coord > 0)
+  if (p.p.*coord + p.rad >= center_.*coord + dims_.*coord / 2 && p.v.*coord > 0)
   {
-    glm::vec3 v = s->get_vel();
-    v.*coord *= -s->elasticity;
-    s->set_vel(v);
-    //s->pos.*coord = center_.*coord + dims_.*coord / 2 - s->rad;
+    p.v.*coord *= -s->get_elasticity();
+    //p.p.*coord = center_.*coord + dims_.*coord / 2 - p.rad;
   }
 }
 
-void CollisionSolver::handle_world_collision2(Sphere *s)
+void CollisionSolver::handle_world_collision2(Particle &p, const Sphere *s)
 {
-  handle_world_collision2_coord(s, &glm::vec3::x);
-  handle_world_collision2_coord(s, &glm::vec3::y);
-  handle_world_collision2_coord(s, &glm::vec3::z);
+  handle_world_collision2_coord(p, s, &glm::vec3::x);
+  handle_world_collision2_coord(p, s, &glm::vec3::y);
+  handle_world_collision2_coord(p, s, &glm::vec3::z);
 }
 
-void CollisionSolver::handle_world_collision(Sphere *s)
+bool CollisionSolver::touches_world(const Particle &p) const
 {
-  // todo: find a way not to lock here
-  std::scoped_lock lock(s->in_collision_m_);
+  for (int i = 0; i < 3; ++i)
+  {
+    if (p.p[i] + p.rad >= center_[i] + dims_[i] * .5f || p.p[i] - p.rad <= center_[i] - dims_[i] * .5f)
+    {
+      return true;
+    }
+  }
 
+  return false;
+}
+
+void CollisionSolver::handle_world_collision(Particle &p, const Sphere *s)
+{
   glm::vec3 n(0.f);
   for (int i = 0; i < 3; ++i)
   {
-    if (s->get_pos()[i] + s->rad >= center_[i] + dims_[i] * .5f)
+    if (p.p[i] + p.rad >= center_[i] + dims_[i] * .5f)
     {
       n[i] = -1.f;
     }
-    else if (s->get_pos()[i] - s->rad <= center_[i] - dims_[i] * .5f)
+    else if (p.p[i] - p.rad <= center_[i] - dims_[i] * .5f)
     {
       n[i] = +1.f;
     }
@@ -87,16 +83,16 @@ void CollisionSolver::handle_world_collision(Sphere *s)
 
   n = glm::normalize(n);
 
-  glm::vec3 vrel = s->get_vel();
+  glm::vec3 vrel = p.v;
   float verl_scl = glm::dot(vrel, n);
 
   if (verl_scl < 0)
   {
-    float imp_nom = -1 * (1 + s->elasticity) * verl_scl;
-    float imp_denom = (1 / s->mass) + 0.f /** wall mass treated as infinite */;
+    float imp_nom = -1 * (1 + s->get_elasticity()) * verl_scl;
+    float imp_denom = p.inv_mass + 0.f /** wall mass treated as infinite */;
     float imp = imp_nom / imp_denom;
 
-    s->set_vel(s->get_vel() + (imp / s->mass) * n);
+    p.v += (imp * p.inv_mass) * n;
   }
 }
 
@@ -105,64 +101,103 @@ void CollisionSolver::handle_world_collision(Sphere *s)
  */
 void NaiveCollisionSolver::handle_collisions(const std::vector<Sphere *> &spheres)
 {
-  for (auto sit1 = spheres.begin(); sit1 != spheres.end(); ++sit1)
+  particles::gather(spheres, particles_);
+
+  for (size_t i = 0; i < particles_.size(); ++i)
   {
-    Sphere *s1 = *sit1;
-    for (auto sit2 = sit1 + 1; sit2 != spheres.end(); ++sit2)
+    Particle &p1 = particles_[i];
+    for (size_t j = i + 1; j < particles_.size(); ++j)
     {
-      Sphere *s2 = *sit2;
+      Particle &p2 = particles_[j];
 
-      if (glm::l2Norm(s1->get_pos(), s2->get_pos()) <= s1->rad + s2->rad)
-        solve_collided_spheres(s1, *sit2);
+      if (glm::l2Norm(p1.p, p2.p) <= p1.rad + p2.rad)
+        solve_collided_spheres(p1, p2);
     }
 
-    handle_world_collision(s1);
+    handle_world_collision(p1, spheres[i]);
   }
+
+  particles::scatter_velocities(particles_, spheres);
 }
 GridRangeSolver::GridRangeSolver(const std::vector<Sphere *> &spheres,
+                                 std::vector<Particle> &particles,
                                  const SphereGridMap &map,
-                                 GridCollisionSolver *solver) : spheres_(spheres),
-                                                                map_(map),
-                                                                solver_(solver) {}
+                                 GridCollisionSolver *solver,
+                                 uint64_t flow_id) : spheres_(spheres),
+                                                     particles_(particles),
+                                                     map_(map),
+                                                     solver_(solver),
+                                                     flow_id_(flow_id) {}
 
 void GridRangeSolver::operator()(const tbb::blocked_range<size_t> &r) const
 {
-  for (size_t i = r.begin(); i != r.end(); ++i)
-  {
-    Sphere *s1 = spheres_[i];
+  PROFILE_SCOPE("grid range");
+  PROFILE_FLOW_STEP("grid dispatch", flow_id_);
+
+  size_t candidates_n = 0;
+  size_t contacts_n = 0;
 
-    std::list<Sphere *> nbs;
+  std::vector<uint32_t> &nbs = solver_->neighbours_.local();
 
-    map_.get_neighbours(s1, nbs);
+  for (size_t i = r.begin(); i != r.end(); ++i)
+  {
+    Particle &p1 = particles_[i];
 
-    bool s1_inside = false;
+    nbs.clear();
+    map_.get_neighbours((uint32_t)i, p1.p, nbs);
 
-    for (auto s2 : nbs)
+    for (uint32_t j : nbs)
     {
-      if (s1 == s2)
+      Particle &p2 = particles_[j];
+
+      candidates_n++;
+      if (glm::l2Norm(p1.p, p2.p) <= p1.rad + p2.rad)
       {
-        s1_inside = true;
-        continue;
+        std::scoped_lock lock(solver_->locks_[i], solver_->locks_[j]);
+        solver_->solve_collided_spheres(p1, p2);
+        contacts_n++;
       }
-
-      if (glm::l2Norm(s1->get_pos(), s2->get_pos()) <= s1->rad + s2->rad)
-        solver_->solve_collided_spheres(s1, s2);
     }
 
-    // DUDU investigate why this throws
-    //assert(s1_inside);
-
-    solver_->handle_world_collision(s1);
+    // positions aren't written here, only the velocity of a sphere at a wall needs the lock.
+    if (solver_->touches_world(p1))
+    {
+      std::scoped_lock lock(solver_->locks_[i]);
+      solver_->handle_world_collision(p1, spheres_[i]);
+    }
   }
+
+  // every pair is seen from both of its spheres.
+  SIM_STAT_ADD("grid candidate pairs", candidates_n / 2.);
+  SIM_STAT_ADD("grid sphere contacts", contacts_n / 2.);
 }
 /*******************************************************************************
  * class GridCollisionSolver Implementation
  */
 void GridCollisionSolver::handle_collisions(const std::vector<Sphere *> &spheres)
 {
-  map_.update_map(spheres);
+  PROFILE_SCOPE("grid collisions");
+
+  {
+    PROFILE_SCOPE("grid rebuild");
+    particles::gather(spheres, particles_);
+    if (locks_.size() < particles_.size())
+    {
+      // mutexes don't move, the vector is replaced.
+      locks_ = std::vector<std::mutex>(particles_.size());
+    }
+    map_.update_map(particles_);
+  }
+
+  // links the dispatch to the ranges tbb ran, on whichever threads.
+  const uint64_t flow_id = Profiler::new_flow_id();
+  PROFILE_FLOW_BEGIN("grid dispatch", flow_id);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, spheres.size()), GridRangeSolver(spheres, particles_, map_, this, flow_id));
+
+  PROFILE_FLOW_END("grid dispatch", flow_id);
 
-  tbb::parallel_for(tbb::blocked_range<size_t>(0, spheres.size()), GridRangeSolver(spheres, map_, this));
+  particles::scatter_velocities(particles_, spheres);
 }
 
 /*******************************************************************************
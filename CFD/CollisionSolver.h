@@ -1,11 +1,14 @@
 #pragma once
 
 #include "Sphere.h"
+#include <cstdint>
 #include <vector>
-#include <shared_mutex>
+#include <mutex>
 #include "gl_incs.h"
+#include "Particle.h"
 #include "SphereGridMap.h"
 #include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 
 enum class sphere_coll_alg
 {
@@ -27,17 +30,25 @@ public: // Formerly ContainingBox
   glm::vec3 dims() const { return dims_; }
 
 protected:
-  void solve_collided_spheres(Sphere *s1,
-                              Sphere *s2,
+  void solve_collided_spheres(Particle &p1,
+                              Particle &p2,
                               // 0 = inelastic, 1 = perfectly elastic
                               float elasticity = .9f);
-  void handle_world_collision(Sphere *s);
-  void handle_world_collision2(Sphere *s);
+  // s is p's sphere, its elasticity is read only on a hit.
+  void handle_world_collision(Particle &p, const Sphere *s);
+  // whether handle_world_collision() can change p, reads only its position.
+  bool touches_world(const Particle &p) const;
+  void handle_world_collision2(Particle &p, const Sphere *s);
 
 private:
-  void handle_world_collision2_coord(Sphere *s,
+  void handle_world_collision2_coord(Particle &p,
+                                     const Sphere *s,
                                      float glm::vec3::*coord);
 
+protected:
+  // the spheres' hot data, reused between calls.
+  std::vector<Particle> particles_;
+
 private:
   glm::vec3 center_; // position of the box's center.
   glm::vec3 dims_;
@@ -79,7 +90,11 @@ public:
 
 private:
   SphereGridMap map_;
-  std::shared_mutex colliders_mutex_;
+  // one per particle, locked only for a contact, away from the particles so the lookups
+  // don't drag them through the cache.
+  std::vector<std::mutex> locks_;
+  // the ranges' neighbour queries, one buffer per thread kept between steps.
+  tbb::enumerable_thread_specific<std::vector<uint32_t>> neighbours_;
 };
 
 class SolverFactory
@@ -92,14 +107,19 @@ class GridRangeSolver
 {
 public:
   GridRangeSolver(const std::vector<Sphere *> &spheres,
+                  std::vector<Particle> &particles,
                   const SphereGridMap &map,
-                  GridCollisionSolver *solver);
+                  GridCollisionSolver *solver,
+                  uint64_t flow_id = 0);
 
 public:
   void operator()(const tbb::blocked_range<size_t> &r) const;
 
 private:
   const std::vector<Sphere *> &spheres_;
+  std::vector<Particle> &particles_;
   const SphereGridMap &map_;
   GridCollisionSolver *solver_;
+  // traces only.
+  uint64_t flow_id_;
 };
\ No newline at end of file
@@ -1,10 +1,15 @@
 
 #include "ImpulseCollisionSolver.h"
 #include "Shape.h"
+#include "LineBatch.h"
+
+#include <algorithm>
 
 static inline constexpr float THRESHOLD = .01f;
 static inline constexpr float EPSILON = .5f;
 
+static inline constexpr float DEBUG_NORMAL_LENGTH = .3f;
+
 static reactphysics3d::Vector3 GlmToRp3d(const glm::vec3 &v)
 {
   return reactphysics3d::Vector3(v.x, v.y, v.z);
@@ -18,6 +23,7 @@ static glm::vec3 Rp3dToGlm(const reactphysics3d::Vector3 &v)
 void ImpulseCollisionSolver::onContact(const CallbackData &callbackData)
 {
   uint32_t contact_pairs_num = callbackData.getNbContactPairs();
+  contact_pairs_n_ += contact_pairs_num;
   for (size_t i = 0; i < contact_pairs_num; ++i)
   {
     auto contact_pair = callbackData.getContactPair(i);
@@ -29,19 +35,31 @@ void ImpulseCollisionSolver::onContact(const CallbackData &callbackData)
       ContactPoint contact_point = contact_pair.getContactPoint(i);
       const glm::vec3 p = Rp3dToGlm(contact_pair.getBody1()->getWorldPoint(contact_point.getLocalPointOnCollider1()));
       const glm::vec3 pt = Rp3dToGlm(contact_pair.getBody2()->getWorldPoint(contact_point.getLocalPointOnCollider2()));
-      contact_pairs_.emplace_back(ContactPointData{
-          shape1,
-          shape2,
-          contact_point.getPenetrationDepth(),
-          // normal dir switched to b2-->b1
-          -Rp3dToGlm(contact_point.getWorldNormal()),
-          p,
-          pt,
-      });
+      // normal dir switched to b2-->b1
+      add_contact(shape1, shape2, contact_point.getPenetrationDepth(), -Rp3dToGlm(contact_point.getWorldNormal()), p, pt);
+      max_penetration_ = std::max(max_penetration_, contact_point.getPenetrationDepth());
     }
   }
 }
 
+void ImpulseCollisionSolver::add_contact(Shape *shape1, Shape *shape2, float penetration_depth, const glm::vec3 &n, const glm::vec3 &p, const glm::vec3 &pt)
+{
+  contact_pairs_.emplace_back(ContactPointData{ shape1, shape2, penetration_depth, n, p, pt });
+}
+
+void ImpulseCollisionSolver::add_debug_normals() const
+{
+  if (!DebugLines::is_enabled())
+  {
+    return;
+  }
+
+  for (const ContactPointData &contact_point : contact_pairs_)
+  {
+    DebugLines::add(contact_point.p, contact_point.p + contact_point.n * DEBUG_NORMAL_LENGTH, glm::vec3(1.f, 0.f, 0.f));
+  }
+}
+
 glm::vec3 get_local_p_vel(Shape *s, const glm::vec3 &loc_p)
 {
   return s->get_vel() + glm::cross(s->get_angular_vel(), loc_p - s->get_pos());
@@ -117,4 +135,6 @@ void ImpulseCollisionSolver::clear()
 {
   had_collisions_ = false;
   contact_pairs_.clear();
+  contact_pairs_n_ = 0;
+  max_penetration_ = 0.f;
 }
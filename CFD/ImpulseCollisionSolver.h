@@ -16,7 +16,15 @@ public:
   void solve();
   bool had_collisions() const { return had_collisions_; }
   bool has_contacts() const { return contact_pairs_.size() > 0; }
+  size_t get_contacts_count() const { return contact_pairs_.size(); }
+  // of the shapes' pairs in contact, since clear().
+  size_t get_contact_pairs_count() const { return contact_pairs_n_; }
+  float get_max_penetration() const { return max_penetration_; }
   void clear();
+  // n points from shape2 to shape1, p and pt are the contact points on each shape.
+  void add_contact(Shape *shape1, Shape *shape2, float penetration_depth, const glm::vec3 &n, const glm::vec3 &p, const glm::vec3 &pt);
+  // the contact normals as DebugLines, once per step, later passes see the same contacts.
+  void add_debug_normals() const;
 
 private:
   struct ContactPointData
@@ -37,4 +45,6 @@ private:
   Simulator *parent_;
   bool had_collisions_ = false;
   std::vector<ContactPointData> contact_pairs_;
+  size_t contact_pairs_n_ = 0;
+  float max_penetration_ = 0.f;
 };
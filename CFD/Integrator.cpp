@@ -0,0 +1,69 @@
+#include "Integrator.h"
+
+void integrator::integrate_body(Transform &transform, Velocity &velocity, Collidable &collidable,
+                                float h, glm::vec3 acc, const glm::vec3 &torque, float damping)
+{
+  // internal forces calculations
+  glm::vec3 damping_force = -damping * velocity.v;
+  acc += damping_force * collidable.inv_mass;
+
+  float angular_damping = 1.f / (1.f + damping);
+
+  // DUDU use semi-implicit euler
+  transform.p += h * velocity.v;
+
+  // linear momentum
+
+  glm::vec3 P_dot(0.f);
+  if (collidable.inv_mass > .0001)
+    P_dot = acc / collidable.inv_mass;
+
+  collidable.P += h * P_dot;
+  velocity.v = collidable.P * collidable.inv_mass;
+
+  glm::mat3 R = glm::toMat3(transform.orientation);
+  collidable.IInv = R * collidable.IBodyInv * glm::transpose(R);
+
+  // angular_momentum
+  glm::vec3 L_dot = torque;
+  collidable.L += L_dot * h * angular_damping;
+  velocity.angular_vel = collidable.IInv * collidable.L;
+
+  glm::quat q = transform.orientation;
+  transform.orientation = glm::normalize((q + 0.5f * glm::quat(0.f, velocity.angular_vel) * q * h));
+}
+
+void integrator::integrate_shape(Shape &shape, float h, glm::vec3 acc, const glm::vec3 &torque, float damping)
+{
+  World &world = shape.get_world();
+  const Entity entity = shape.get_entity();
+
+  integrate_body(world.get_transforms().get(entity), world.get_velocities().get(entity), shape.get_collidable(),
+                 h, acc, torque, damping);
+}
+
+size_t integrator::integrate_bodies(World &world, float h, const glm::vec3 &force, const glm::vec3 &torque, float damping,
+                                    float awake_speed)
+{
+  ComponentTable<Transform> &transforms = world.get_transforms();
+  ComponentTable<Velocity> &velocities = world.get_velocities();
+  const std::vector<Entity> &entities = world.get_collidables().get_entities();
+  std::vector<Collidable> &collidables = world.get_collidables().get_data();
+  size_t awake_n = 0;
+
+  for (size_t i = 0; i < collidables.size(); ++i)
+  {
+    Collidable &collidable = collidables[i];
+    const Entity entity = entities[i];
+
+    Velocity &velocity = velocities.get(entity);
+    integrate_body(transforms.get(entity), velocity, collidable,
+                   h, force * collidable.inv_mass, torque * collidable.inv_mass, damping);
+
+    if (collidable.inv_mass > 0.f &&
+        glm::length2(velocity.v) + glm::length2(velocity.angular_vel) > awake_speed * awake_speed)
+      awake_n++;
+  }
+
+  return awake_n;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Shape.h"
+#include "World.h"
+
+namespace integrator
+{
+  // advances a body by h, acc and torque are external, damping is applied here.
+  void integrate_body(Transform &transform, Velocity &velocity, Collidable &collidable,
+                      float h, glm::vec3 acc, const glm::vec3 &torque, float damping);
+  // the same for a shape with a collidable.
+  void integrate_shape(Shape &shape, float h, glm::vec3 acc, const glm::vec3 &torque, float damping);
+  // every body of the world, force and torque are scaled by each body's inverse mass. returns
+  // the movable bodies faster than awake_speed after the step, counted in the same pass.
+  size_t integrate_bodies(World &world, float h, const glm::vec3 &force, const glm::vec3 &torque, float damping,
+                          float awake_speed = 0.f);
+}
@@ -0,0 +1,24 @@
+#include "Particle.h"
+
+#include <cassert>
+
+void particles::gather(const std::vector<Sphere *> &spheres, std::vector<Particle> &particles)
+{
+  particles.resize(spheres.size());
+
+  for (size_t i = 0; i < spheres.size(); ++i)
+  {
+    const Sphere *s = spheres[i];
+    particles[i] = Particle{ s->get_pos(), s->rad, s->get_vel(), 1.f / s->mass };
+  }
+}
+
+void particles::scatter_velocities(const std::vector<Particle> &particles, const std::vector<Sphere *> &spheres)
+{
+  assert(particles.size() == spheres.size());
+
+  for (size_t i = 0; i < spheres.size(); ++i)
+  {
+    spheres[i]->set_vel(particles[i].v);
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "gl_incs.h"
+#include "Sphere.h"
+
+#include <vector>
+
+/**
+ * What the sphere solvers read and write per sphere, packed so two share a cache line.
+ * Gathered from the spheres before solving, the velocities scattered back after. The rest
+ * of a sphere (its elasticity, renderable, collidable) isn't touched by the narrowphase.
+ */
+struct Particle
+{
+  glm::vec3 p;
+  float rad;
+  glm::vec3 v;
+  float inv_mass;
+};
+
+static_assert(sizeof(Particle) == 32, "a particle should stay 32 bytes");
+
+namespace particles
+{
+  // particles[i] is spheres[i], the vector is reused, it only grows.
+  void gather(const std::vector<Sphere *> &spheres, std::vector<Particle> &particles);
+  void scatter_velocities(const std::vector<Particle> &particles, const std::vector<Sphere *> &spheres);
+}
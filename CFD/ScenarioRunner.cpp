@@ -0,0 +1,169 @@
+#include "ScenarioRunner.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utils.h>
+#include <AllocTracker.h>
+
+static constexpr const char *SCENE_NAMES[] = { "gas", "pile", "tower", "mixed", "dam_break" };
+
+const char *ScenarioRunner::get_scene_name(Simulator::Scene scene)
+{
+  return SCENE_NAMES[static_cast<size_t>(scene)];
+}
+
+Simulator::Scene ScenarioRunner::parse_scene(const std::string &name)
+{
+  for (size_t i = 0; i < std::size(SCENE_NAMES); ++i)
+  {
+    if (name == SCENE_NAMES[i])
+      return static_cast<Simulator::Scene>(i);
+  }
+
+  throw std::runtime_error("unknown scene: " + name);
+}
+
+ScenarioRunner::ScenarioRunner(const Config &config) : config_(config)
+{
+}
+
+// FNV-1a over the bytes of the values.
+static void hash_floats(uint64_t &hash, const float *values, size_t values_n)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(values);
+  for (size_t i = 0; i < values_n * sizeof(float); ++i)
+  {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+}
+
+void ScenarioRunner::run()
+{
+  Simulator sim(config_.spheres_n, config_.boxes_n, config_.seed);
+  sim.init(config_.scene, true);
+
+  if (!config_.stats_path.empty())
+  {
+#ifdef BE_SIM_STATS
+    SimStats::get().start_csv(config_.stats_path);
+#else
+    throw std::runtime_error("simulation stats need a BE_SIM_STATS build");
+#endif
+  }
+
+  if (config_.alloc_free)
+  {
+#ifdef BE_TRACK_ALLOCS
+    AllocTracker::get().set_steady_state(config_.alloc_warmup_steps);
+#else
+    throw std::runtime_error("allocation checks need a BE_TRACK_ALLOCS build");
+#endif
+  }
+
+  // fixed steps, a frame's wall time would change the simulation between runs.
+  const float h = sim.get_fixed_h();
+  steps_stats_.clear();
+  steps_stats_.reserve(config_.steps);
+
+  double start = utility::get_time();
+  for (unsigned int i = 0; i < config_.steps; ++i)
+  {
+    steps_stats_.push_back(sim.step(h));
+  }
+  double total_ms = (utility::get_time() - start) * 1000.;
+
+  SimStats::get().stop_csv();
+
+  checksum_ = 14695981039346656037ull;
+  auto hash_shape = [this](const Shape *shape) {
+    glm::vec3 pos = shape->get_pos();
+    glm::quat orientation = shape->get_orientation();
+    hash_floats(checksum_, &pos.x, 3);
+    hash_floats(checksum_, &orientation.x, 4);
+  };
+  for (const Sphere *sphere : sim.get_spheres())
+    hash_shape(sphere);
+  for (const Box *box : sim.get_boxes())
+    hash_shape(box);
+
+  if (config_.output_path.empty())
+  {
+    write_json(std::cout, total_ms);
+    return;
+  }
+
+  std::ofstream file(config_.output_path);
+  if (!file)
+    throw std::runtime_error("can't open " + config_.output_path);
+
+  write_json(file, total_ms);
+
+  if (!file)
+    throw std::runtime_error("can't write " + config_.output_path);
+}
+
+// mean, p50, p99, max and total of a value over all the steps.
+template <typename T, typename Getter>
+static void write_summary(std::ostream &out, const char *name, const std::vector<T> &steps_stats, Getter get)
+{
+  std::vector<double> values;
+  values.reserve(steps_stats.size());
+  for (const T &stats : steps_stats)
+    values.push_back(static_cast<double>(get(stats)));
+
+  double total = 0.;
+  for (double v : values)
+    total += v;
+
+  std::sort(values.begin(), values.end());
+  auto percentile = [&values](double p) {
+    return values.empty() ? 0. : values[std::min(values.size() - 1, static_cast<size_t>(p * values.size()))];
+  };
+
+  out << "    \"" << name << "\": {"
+      << "\"mean\": " << (values.empty() ? 0. : total / values.size())
+      << ", \"p50\": " << percentile(.5)
+      << ", \"p99\": " << percentile(.99)
+      << ", \"max\": " << (values.empty() ? 0. : values.back())
+      << ", \"total\": " << total << "}";
+}
+
+void ScenarioRunner::write_json(std::ostream &out, double total_ms) const
+{
+  using StepStats = Simulator::StepStats;
+
+  out << "{\n"
+      << "  \"scene\": \"" << get_scene_name(config_.scene) << "\",\n"
+      << "  \"seed\": " << config_.seed << ",\n"
+      << "  \"steps\": " << config_.steps << ",\n"
+      << "  \"spheres\": " << config_.spheres_n << ",\n"
+      << "  \"boxes\": " << config_.boxes_n << ",\n"
+      << "  \"total_ms\": " << total_ms << ",\n"
+      << "  \"checksum\": \"" << std::hex << checksum_ << std::dec << "\",\n";
+
+  out << "  \"phases_ms\": {\n";
+  write_summary(out, "collision_detection", steps_stats_, [](const StepStats &s) { return s.collision_detection_ms; });
+  out << ",\n";
+  write_summary(out, "solver", steps_stats_, [](const StepStats &s) { return s.solver_ms; });
+  out << ",\n";
+  write_summary(out, "integrate", steps_stats_, [](const StepStats &s) { return s.integrate_ms; });
+  out << ",\n";
+  write_summary(out, "transform_sync", steps_stats_, [](const StepStats &s) { return s.transform_sync_ms; });
+  out << "\n  },\n";
+
+  out << "  \"per_step\": {\n";
+  write_summary(out, "contacts", steps_stats_, [](const StepStats &s) { return s.contacts; });
+  out << ",\n";
+  write_summary(out, "solver_iterations", steps_stats_, [](const StepStats &s) { return s.solver_iterations; });
+#ifdef BE_TRACK_ALLOCS
+  out << ",\n";
+  write_summary(out, "allocs", steps_stats_, [](const StepStats &s) { return s.allocs; });
+  out << ",\n";
+  write_summary(out, "alloc_bytes", steps_stats_, [](const StepStats &s) { return s.alloc_bytes; });
+#endif
+  out << "\n  }\n"
+      << "}\n";
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Simulator.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * Runs a standard scene headless for a fixed number of fixed steps and writes
+ * the timings as JSON. Equal configs give equal contacts, iterations and
+ * checksum, only the timings differ between runs.
+ */
+class ScenarioRunner
+{
+public:
+  struct Config
+  {
+    Simulator::Scene scene = Simulator::Scene::gas;
+    unsigned int seed = 1;
+    unsigned int steps = 600;
+    unsigned int spheres_n = 1000;
+    unsigned int boxes_n = 20;
+    std::string output_path; // empty writes to stdout
+    std::string stats_path;  // a SimStats CSV of every step if set, needs BE_SIM_STATS
+    // fail on any allocation in a step after alloc_warmup_steps steps, needs BE_TRACK_ALLOCS
+    bool alloc_free = false;
+    unsigned int alloc_warmup_steps = 0;
+  };
+
+public:
+  explicit ScenarioRunner(const Config &config);
+
+public:
+  // throws std::runtime_error if the output can't be written.
+  void run();
+  // the final positions and orientations hashed, compares runs without diffing states.
+  uint64_t get_checksum() const { return checksum_; }
+
+public:
+  static const char *get_scene_name(Simulator::Scene scene);
+  // throws std::runtime_error on an unknown name.
+  static Simulator::Scene parse_scene(const std::string &name);
+
+private:
+  void write_json(std::ostream &out, double total_ms) const;
+
+private:
+  Config config_;
+  std::vector<Simulator::StepStats> steps_stats_;
+  uint64_t checksum_ = 0;
+};
@@ -0,0 +1,259 @@
+#include "SimStats.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+static constexpr double NO_MAX = std::numeric_limits<double>::lowest();
+
+SimStats &SimStats::get()
+{
+  static SimStats stats;
+  return stats;
+}
+
+SimStats::Slot::Slot()
+{
+  // atomics aren't zeroed by their default constructor before c++20.
+  for (size_t i = 0; i < MAX_STATS; ++i)
+  {
+    values[i].store(0., std::memory_order_relaxed);
+    maxima[i].store(NO_MAX, std::memory_order_relaxed);
+    for (std::atomic<uint64_t> &bucket : buckets[i])
+      bucket.store(0, std::memory_order_relaxed);
+  }
+}
+
+SimStats::Slot &SimStats::get_slot()
+{
+  // the registry keeps the slot alive after its thread exits so its last values are still read.
+  thread_local std::shared_ptr<Slot> slot;
+  if (!slot)
+  {
+    slot = std::make_shared<Slot>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    slots_.push_back(slot);
+  }
+
+  return *slot;
+}
+
+size_t SimStats::add_stat(const char *name, Kind kind, double bucket_width)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = stat_ids_.find(name);
+  if (it != stat_ids_.end())
+    return it->second;
+
+  const size_t id = stats_n_.load(std::memory_order_relaxed);
+  if (id == MAX_STATS)
+    throw std::runtime_error(std::string("too many simulation stats, can't add ") + name);
+
+  stats_[id] = Stat{ name, kind, bucket_width };
+  stat_ids_.emplace(name, id);
+  stats_n_.store(id + 1, std::memory_order_release);
+
+  return id;
+}
+
+void SimStats::add(size_t id, double value)
+{
+  // a single writer per slot, no read-modify-write needed.
+  std::atomic<double> &dst = get_slot().values[id];
+  dst.store(dst.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void SimStats::max(size_t id, double value)
+{
+  std::atomic<double> &dst = get_slot().maxima[id];
+  if (value > dst.load(std::memory_order_relaxed))
+    dst.store(value, std::memory_order_relaxed);
+}
+
+void SimStats::sample(size_t id, double value)
+{
+  Slot &slot = get_slot();
+  const double bucket_width = stats_[id].bucket_width;
+
+  slot.values[id].store(slot.values[id].load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  if (value > slot.maxima[id].load(std::memory_order_relaxed))
+    slot.maxima[id].store(value, std::memory_order_relaxed);
+
+  size_t bucket = value <= 0. ? 0 : std::min(BUCKETS_N - 1, static_cast<size_t>(value / bucket_width));
+  std::atomic<uint64_t> &count = slot.buckets[id][bucket];
+  count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void SimStats::end_step(double step_ms)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  const size_t stats_n = stats_n_.load(std::memory_order_acquire);
+  values_.resize(stats_n);
+
+  for (size_t id = 0; id < stats_n; ++id)
+  {
+    const Stat &stat = stats_[id];
+    Value &v = values_[id];
+    v.name = stat.name;
+    v.kind = stat.kind;
+    v.value = 0.;
+    v.max = NO_MAX;
+    v.samples_n = 0;
+    v.bucket_width = stat.bucket_width;
+    v.buckets.fill(0);
+
+    for (auto &slot : slots_)
+    {
+      v.value += slot->values[id].exchange(0., std::memory_order_relaxed);
+      v.max = std::max(v.max, slot->maxima[id].exchange(NO_MAX, std::memory_order_relaxed));
+      if (stat.kind == Kind::histogram)
+      {
+        for (size_t b = 0; b < BUCKETS_N; ++b)
+          v.buckets[b] += slot->buckets[id][b].exchange(0, std::memory_order_relaxed);
+      }
+    }
+
+    // nothing recorded this step.
+    if (v.max == NO_MAX)
+      v.max = 0.;
+
+    if (stat.kind == Kind::max)
+    {
+      v.value = v.max;
+    }
+    else if (stat.kind == Kind::histogram)
+    {
+      for (uint64_t count : v.buckets)
+        v.samples_n += count;
+      v.value = v.samples_n > 0 ? v.value / v.samples_n : 0.;
+    }
+  }
+
+  if (csv_.is_open())
+  {
+    if (csv_columns_n_ == 0)
+      write_csv_header();
+    else if (csv_columns_n_ < values_.size())
+      rewrite_csv();
+    write_csv_row(step_ms);
+  }
+
+  step_idx_++;
+}
+
+void SimStats::start_csv(const std::string &path, size_t flush_steps)
+{
+  stop_csv();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  csv_.open(path);
+  if (!csv_)
+    throw std::runtime_error("can't open " + path);
+  csv_path_ = path;
+
+  csv_flush_steps_ = std::max<size_t>(1, flush_steps);
+}
+
+void SimStats::stop_csv()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!csv_.is_open())
+    return;
+
+  csv_ << csv_rows_;
+  csv_.close();
+  csv_rows_.clear();
+  csv_columns_n_ = 0;
+  csv_pending_rows_ = 0;
+}
+
+void SimStats::write_csv_header()
+{
+  csv_columns_n_ = values_.size();
+
+  csv_ << "step,step ms";
+  for (size_t id = 0; id < csv_columns_n_; ++id)
+  {
+    const Stat &stat = stats_[id];
+    if (stat.kind != Kind::histogram)
+    {
+      csv_ << ',' << stat.name;
+      continue;
+    }
+
+    csv_ << ',' << stat.name << " n," << stat.name << " mean," << stat.name << " max";
+    for (size_t b = 0; b < BUCKETS_N; ++b)
+    {
+      csv_ << ',' << stat.name << " [" << b * stat.bucket_width << ':';
+      if (b + 1 < BUCKETS_N)
+        csv_ << (b + 1) * stat.bucket_width << ')';
+      else
+        csv_ << ')';
+    }
+  }
+  csv_ << '\n';
+}
+
+void SimStats::rewrite_csv()
+{
+  csv_ << csv_rows_;
+  csv_.close();
+  csv_rows_.clear();
+  csv_pending_rows_ = 0;
+
+  // the new stats saw nothing in the rows written so far.
+  std::string padding;
+  for (size_t id = csv_columns_n_; id < values_.size(); ++id)
+  {
+    const size_t columns_n = stats_[id].kind == Kind::histogram ? 3 + BUCKETS_N : 1;
+    for (size_t c = 0; c < columns_n; ++c)
+      padding += ",0";
+  }
+
+  std::ifstream in(csv_path_);
+  if (!in)
+    throw std::runtime_error("can't read " + csv_path_);
+
+  std::string line;
+  std::string rows;
+  std::getline(in, line); // the old header
+  while (std::getline(in, line))
+    rows += line + padding + '\n';
+  in.close();
+
+  csv_.open(csv_path_, std::ios::trunc);
+  if (!csv_)
+    throw std::runtime_error("can't open " + csv_path_);
+
+  write_csv_header();
+  csv_ << rows;
+}
+
+void SimStats::write_csv_row(double step_ms)
+{
+  csv_rows_ += std::to_string(step_idx_) + ',' + std::to_string(step_ms);
+  for (size_t id = 0; id < csv_columns_n_; ++id)
+  {
+    const Value &v = values_[id];
+    if (v.kind != Kind::histogram)
+    {
+      csv_rows_ += ',' + std::to_string(v.value);
+      continue;
+    }
+
+    csv_rows_ += ',' + std::to_string(v.samples_n) + ',' + std::to_string(v.value) + ',' + std::to_string(v.max);
+    for (uint64_t count : v.buckets)
+      csv_rows_ += ',' + std::to_string(count);
+  }
+  csv_rows_ += '\n';
+
+  if (++csv_pending_rows_ == csv_flush_steps_)
+  {
+    csv_ << csv_rows_;
+    csv_.flush();
+    csv_rows_.clear();
+    csv_pending_rows_ = 0;
+  }
+}
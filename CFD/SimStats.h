@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Simulation counters and histograms. Hot paths write to a slot of their thread without
+ * locks, end_step() folds the slots into the step's values, which stay readable until the
+ * next end_step() and are appended to a CSV while one is open.
+ *
+ * Use the macros, they compile to nothing without BE_SIM_STATS. It is separate from BE_PROFILE
+ * so Release builds can write the CSV without profiling:
+ *   SIM_STAT_ADD("contacts", n);                  // summed over the step
+ *   SIM_STAT_MAX("max penetration", depth);       // largest of the step
+ *   SIM_STAT_HISTOGRAM("grid occupancy", n, 1.);  // buckets of width 1 from 0, the last is open
+ *
+ * Each call site registers its name once, sites with the same name share the stat. Hot
+ * loops should add their local total once rather than per element.
+ */
+class SimStats
+{
+public:
+  static inline constexpr size_t MAX_STATS = 64;
+  static inline constexpr size_t BUCKETS_N = 16;
+
+  enum class Kind
+  {
+    sum,
+    max,
+    histogram,
+  };
+
+  struct Value
+  {
+    std::string name;
+    Kind kind;
+    double value;        // sum or max, the mean of the samples for histograms
+    double max;          // max stats and histograms
+    uint64_t samples_n;  // histograms
+    double bucket_width; // histograms
+    std::array<uint64_t, BUCKETS_N> buckets;
+  };
+
+public:
+  static SimStats &get();
+
+  // called by the macros, throws std::runtime_error past MAX_STATS.
+  size_t add_stat(const char *name, Kind kind, double bucket_width = 1.);
+  void add(size_t id, double value);
+  void max(size_t id, double value);
+  void sample(size_t id, double value);
+
+  // once the step's hot paths returned, on the thread that steps.
+  void end_step(double step_ms);
+  // in order of registration, a stat that saw nothing this step is 0.
+  const std::vector<Value> &get_values() const { return values_; }
+
+  // a row per step from the next end_step() on, flushed every flush_steps steps. A stat
+  // registered after the header rewrites the file with its columns, 0 in the earlier rows.
+  // throws std::runtime_error.
+  void start_csv(const std::string &path, size_t flush_steps = 60);
+  void stop_csv();
+  bool is_writing_csv() const { return csv_.is_open(); }
+
+private:
+  SimStats() = default;
+
+  // written only by its thread, read and reset only by end_step().
+  struct Slot
+  {
+    Slot();
+
+    std::array<std::atomic<double>, MAX_STATS> values; // sum, or sum of the samples
+    std::array<std::atomic<double>, MAX_STATS> maxima; // of max stats and histograms
+    std::array<std::array<std::atomic<uint64_t>, BUCKETS_N>, MAX_STATS> buckets;
+  };
+
+  struct Stat
+  {
+    std::string name;
+    Kind kind;
+    double bucket_width;
+  };
+
+  Slot &get_slot();
+  void write_csv_header();
+  void rewrite_csv();
+  void write_csv_row(double step_ms);
+
+private:
+  mutable std::mutex mutex_; // registry, never taken by add(), max() or sample()
+  std::vector<std::shared_ptr<Slot>> slots_;
+  std::array<Stat, MAX_STATS> stats_;
+  std::atomic<size_t> stats_n_{ 0 };
+  std::unordered_map<std::string, size_t> stat_ids_;
+
+  std::vector<Value> values_;
+  size_t step_idx_ = 0;
+
+  std::ofstream csv_;
+  std::string csv_path_;
+  std::string csv_rows_;
+  size_t csv_columns_n_ = 0; // stats written per row, 0 until the header is
+  size_t csv_flush_steps_ = 0;
+  size_t csv_pending_rows_ = 0;
+};
+
+#ifdef BE_SIM_STATS
+#define SIM_STAT_IMPL(kind, call, name, value, bucket_width)                                 \
+  do                                                                                         \
+  {                                                                                          \
+    static const size_t sim_stat_id = SimStats::get().add_stat(name, kind, bucket_width);    \
+    SimStats::get().call(sim_stat_id, static_cast<double>(value));                           \
+  } while (0)
+#define SIM_STAT_ADD(name, value) SIM_STAT_IMPL(SimStats::Kind::sum, add, name, value, 1.)
+#define SIM_STAT_MAX(name, value) SIM_STAT_IMPL(SimStats::Kind::max, max, name, value, 1.)
+#define SIM_STAT_HISTOGRAM(name, value, bucket_width) SIM_STAT_IMPL(SimStats::Kind::histogram, sample, name, value, bucket_width)
+#define SIM_STATS_END_STEP(step_ms) SimStats::get().end_step(step_ms)
+#else
+#define SIM_STAT_ADD(name, value) ((void)0)
+#define SIM_STAT_MAX(name, value) ((void)0)
+#define SIM_STAT_HISTOGRAM(name, value, bucket_width) ((void)0)
+#define SIM_STATS_END_STEP(step_ms) ((void)0)
+#endif
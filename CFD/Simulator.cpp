@@ -1,20 +1,32 @@
 #include "Simulator.h"
+#include "Integrator.h"
 
-#include <stdlib.h> /* srand, rand */
-#include <time.h>   /* time */
+#include <algorithm>
+#include <cassert>
+#include <cmath>
 #include <glm/gtx/norm.hpp>
 #include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
 #include <utils.h>
+#include <Profiler.h>
+#include "SimStats.h"
+#include <AllocTracker.h>
 
 static const glm::vec3 GRAVITY(0.f, -.9f, 0.f);
+// bodies slower than this, linearly and angularly, count as resting in the stats.
+static constexpr float AWAKE_SPEED = .01f;
 
 Simulator::Simulator(unsigned int spheres_n,
-                     unsigned int boxes_n) : sphere_coll_alg_(sphere_coll_alg::grid),
+                     unsigned int boxes_n,
+                     unsigned int seed) : sphere_coll_alg_(sphere_coll_alg::grid),
                                              base_h_(.03f),
                                              damping_(.09f),
                                              spheres_n_(spheres_n),
                                              boxes_n_(boxes_n),
                                              sphere_rad_(.1f),
+                                             rng_(seed),
                                              engine_(std::bind(&Simulator::key_callback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4)),
                                              impulse_solver_(this)
 {
@@ -30,6 +42,8 @@ Simulator::Simulator(unsigned int spheres_n,
 
 void Simulator::handle_collisions()
 {
+  PROFILE_SCOPE("collisions");
+
   // Sphere collisions
   //col_solver_->handle_collisions(spheres_);
 
@@ -45,19 +59,37 @@ void Simulator::handle_collisions()
 
     impulse_solver_.clear();
 
-    world_->testCollision(impulse_solver_);
+    double start = utility::get_time();
+    {
+      PROFILE_SCOPE("collision detection");
+      world_->testCollision(impulse_solver_);
+    }
+    double detected = utility::get_time();
+    step_stats_.collision_detection_ms += (detected - start) * 1000.;
+
+    // later passes see the same contacts again, after their resolution.
+    if (solver_iteration_counter == 0)
+    {
+      step_stats_.contacts = impulse_solver_.get_contacts_count();
+      impulse_solver_.add_debug_normals();
+      SIM_STAT_ADD("contact pairs", impulse_solver_.get_contact_pairs_count());
+      SIM_STAT_ADD("contacts", impulse_solver_.get_contacts_count());
+      SIM_STAT_MAX("max penetration", impulse_solver_.get_max_penetration());
+    }
 
     if (impulse_solver_.has_contacts())
     {
+      PROFILE_SCOPE("solver");
       impulse_solver_.solve();
       solver_iteration_counter++;
+      step_stats_.solver_ms += (utility::get_time() - detected) * 1000.;
     }
   } while (impulse_solver_.had_collisions());
 
-  if (solver_iteration_counter > 0)
-  {
-    //std::cout << "Solved after " << solver_iteration_counter << " iterations\n";
-  }
+  step_stats_.solver_iterations = solver_iteration_counter;
+  PROFILE_COUNTER("solver iterations", solver_iteration_counter);
+  SIM_STAT_HISTOGRAM("solver iterations", solver_iteration_counter, 2.);
+  SIM_STAT_ADD("solver iteration cap hits", solver_iteration_counter == 30 ? 1 : 0);
 }
 
 Simulator::~Simulator()
@@ -109,7 +141,7 @@ void Simulator::remove_global_torque(const std::string &name)
 static void projectile(Arrow *arrow)
 {
   static std::once_flag of;
-  static double kin_start_time_ = glfwGetTime();
+  static double kin_start_time_ = utility::get_time();
   std::call_once(of, [&]()
                  {
                    float theta_start_deg = 45.f;
@@ -140,7 +172,7 @@ static void projectile(Arrow *arrow)
                                                                     sin(half_angle) * 0.f))));
                  });
 
-  double t = glfwGetTime();
+  double t = utility::get_time();
   float delta = static_cast<float>(t - kin_start_time_) * 3.f;
 
   glm::vec3 g = GRAVITY;
@@ -159,7 +191,7 @@ static void projectile(Arrow *arrow)
 static void circle(Arrow *arrow)
 {
   static std::once_flag of;
-  static double last_time = glfwGetTime();
+  static double last_time = utility::get_time();
   // inputs
   static float rad = 1.f;
   static glm::vec3 p0(1.f, 0.f, 0.f);
@@ -174,7 +206,7 @@ static void circle(Arrow *arrow)
                    // orientation
                    arrow->orient(p0);
                  });
-  double t = glfwGetTime();
+  double t = utility::get_time();
   float delta = static_cast<float>(t - last_time) * 3.f;
   last_time = t;
 
@@ -191,7 +223,7 @@ static void circle(Arrow *arrow)
 static void circle2(Arrow *arrow)
 {
   static std::once_flag of;
-  static double last_time = glfwGetTime();
+  static double last_time = utility::get_time();
   // inputs
   static float rad = 1.f;
   static glm::vec3 p0(1.f, 0.f, 0.f);
@@ -206,7 +238,7 @@ static void circle2(Arrow *arrow)
                    // orientation
                    arrow->orient(p0);
                  });
-  double t = glfwGetTime();
+  double t = utility::get_time();
   float delta = static_cast<float>(t - last_time);
 
   float v_length = glm::l2Norm(v0);
@@ -222,6 +254,8 @@ static void circle2(Arrow *arrow)
 
 void Simulator::kinematics()
 {
+  PROFILE_SCOPE("kinematics");
+
   static Arrow *arrow_proj = engine_.get_arrow(engine_.add_arrow(glm::vec3(0.f, 0.f, 0.f), glm::vec3(.5f, 1.f, .5f), true));
   static Arrow *arrow_circle = engine_.get_arrow(engine_.add_arrow(glm::vec3(0.f, 0.f, 0.f), glm::vec3(.5f, 1.f, .5f), true));
 
@@ -232,11 +266,11 @@ void Simulator::kinematics()
   arrow_circle->update_model_if_renderable(arrow_circle->get_dims());
 }
 
-void Simulator::integrate()
+float Simulator::get_frame_h()
 {
   static bool init = true;
 
-  double curr_time = glfwGetTime();
+  double curr_time = utility::get_time();
 
   if (init)
   {
@@ -247,16 +281,42 @@ void Simulator::integrate()
   float delta = (float)(curr_time - last_time_);
   last_time_ = curr_time;
 
-  float h = base_h_ * 133.33f * delta;
-  //integrate_spheres(h);
-  integrate_shapes(h);
+  return base_h_ * 133.33f * delta;
 }
 
-static float get_rand(float low = -.5f, float high = .5f)
+Simulator::StepStats Simulator::step(float h)
 {
-  float r3 = low + static_cast<float>(rand()) / (static_cast<float>(RAND_MAX / (high - low)));
+  ALLOC_BEGIN_STEP();
+
+  DebugLines::begin_step();
+  step_stats_ = StepStats{};
+  double start = utility::get_time();
+
+  handle_collisions();
+
+  {
+    PROFILE_SCOPE("integrate");
+    double integrate_start = utility::get_time();
+    //integrate_spheres(h);
+    integrate_shapes(h);
+    step_stats_.integrate_ms = (utility::get_time() - integrate_start) * 1000.;
+  }
+
+  SIM_STATS_END_STEP((utility::get_time() - start) * 1000.);
 
-  return r3;
+  ALLOC_END_STEP();
+#ifdef BE_TRACK_ALLOCS
+  AllocTracker::Counts allocs = AllocTracker::get().get_step_counts();
+  step_stats_.allocs = allocs.allocs;
+  step_stats_.alloc_bytes = allocs.bytes;
+#endif
+
+  return step_stats_;
+}
+
+float Simulator::get_rand(float low, float high)
+{
+  return std::uniform_real_distribution<float>(low, high)(rng_);
 }
 
 void Simulator::integrate_spheres(float h)
@@ -292,65 +352,35 @@ void Simulator::integrate_spheres(float h)
       std::cout << "curr pos (" << lowSphere->get_pos().x << "," << lowSphere->get_pos().y << "," << lowSphere->get_pos().z << ")\n\n";
     }
 
-    sphere->colliders_.clear();
-
     sphere->update_model_if_renderable(glm::vec3(sphere->rad)); // DUDU identity orientation
   }
 }
 
 void Simulator::integrate_shapes(float h)
 {
-  // DUDU refactor this ugliness
-  std::vector<Shape *> shapes;
-  std::copy(boxes_.begin(), boxes_.end(), std::back_inserter(shapes));
-  std::copy(spheres_.begin(), spheres_.end(), std::back_inserter(shapes));
-  for (auto shape : shapes)
-  {
-    glm::vec3 acc(0.f);
-    glm::vec3 torque(0.f);
-
-    for (auto f : g_forces_)
-    {
-      acc += f.second * shape->get_collidable().inv_mass;
-    }
-    for (auto f : g_torques_)
-    {
-      torque += f.second * shape->get_collidable().inv_mass;
-    }
-
-    // internal forces calculations
-    glm::vec3 damping_force = -damping_ * shape->get_vel();
-    acc += damping_force * shape->get_collidable().inv_mass;
-
-    float angular_damping = 1.f / (1.f + damping_);
+  World &world = engine_.get_world();
 
-    // DUDU use semi-implicit euler
-    shape->set_pos(shape->get_pos() + h * shape->get_vel());
-
-    // linear momentum
-
-    glm::vec3 P_dot(0.f);
-    if (shape->get_collidable().inv_mass > .0001)
-      P_dot = acc / shape->get_collidable().inv_mass;
-
-    shape->get_collidable().P += h * P_dot;
-    shape->set_vel(shape->get_collidable().P * shape->get_collidable().inv_mass);
+  glm::vec3 force(0.f);
+  glm::vec3 torque(0.f);
+  for (auto f : g_forces_)
+  {
+    force += f.second;
+  }
+  for (auto f : g_torques_)
+  {
+    torque += f.second;
+  }
 
-    glm::mat3 R = glm::toMat3(shape->get_orientation());
-    shape->get_collidable().IInv = R * shape->get_collidable().IBodyInv * glm::transpose(R);
+  // counted while the velocities are at hand, a second pass over the bodies cost more than the profiler.
+  [[maybe_unused]] const size_t awake_n = integrator::integrate_bodies(world, h, force, torque, damping_, AWAKE_SPEED);
 
-    // angular_momentum
-    glm::vec3 L_dot = torque;
-    shape->get_collidable().L += L_dot * h * angular_damping;
-    shape->set_angular_vel(shape->get_collidable().IInv * shape->get_collidable().L);
+  world.sync_render_instances();
 
-    glm::quat q = shape->get_orientation();
-    shape->set_orientation(glm::normalize((q + 0.5f * glm::quat(0.f, shape->get_angular_vel()) * q * h)));
-
-    shape->update_model_if_renderable(glm::vec3(shape->get_dims())); // DUDU identity orientation
-  }
+  SIM_STAT_ADD("bodies awake", awake_n);
 
   // update reactphysics3d world
+  PROFILE_SCOPE("transform sync");
+  double start = utility::get_time();
   for (reactphysics3d::CollisionBody *body : bodies_)
   {
     Shape *shape = reinterpret_cast<Shape *>(body->getUserData());
@@ -361,54 +391,198 @@ void Simulator::integrate_shapes(float h)
 
     body->setTransform(transform);
   }
+  step_stats_.transform_sync_ms = (utility::get_time() - start) * 1000.;
 }
 
-void Simulator::init()
+void Simulator::init(Scene scene, bool headless, BadEngine::Backend backend)
 {
+  headless_ = headless;
+  offscreen_ = !headless_ && backend == BadEngine::Backend::offscreen;
+
   engine_.set_sphere_radius(sphere_rad_);
   engine_.set_world_dims(col_solver_->dims());
-  engine_.init();
+  if (!headless_)
+  {
+    engine_.init(backend);
+  }
 
   add_global_force("gravity", GRAVITY);
 
-  std::vector<size_t> elem_indices;
+  switch (scene)
+  {
+  case Scene::gas:
+    init_gas();
+    break;
+  case Scene::pile:
+    init_pile();
+    break;
+  case Scene::tower:
+    init_tower();
+    break;
+  case Scene::mixed:
+    init_mixed();
+    break;
+  case Scene::dam_break:
+    init_dam_break();
+    break;
+  default:
+    assert(0);
+  }
+
+  init_boundaries();
+  init_bodies();
+
+  debug_line_ = engine_.get_line(engine_.add_line(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 0.f)));
+}
+
+void Simulator::add_sphere(const glm::vec3 &pos, const glm::vec3 &vel)
+{
+  Sphere *s = engine_.get_sphere(engine_.add_sphere(pos.x, pos.y, pos.z, false, !headless_));
+  s->set_initial_vel(vel);
+  spheres_.push_back(s);
+}
+
+void Simulator::add_box(const glm::vec3 &pos, const glm::vec3 &vel)
+{
+  Box *b = engine_.get_box(engine_.add_box(pos, glm::vec3(.4f, .4f, .4f), false, !headless_));
+  b->set_initial_vel(vel);
+  boxes_.push_back(b);
+}
+
+// lattice rows along x, then z, then up from min.y, the jitter keeps the layers from stacking
+// perfectly. throws std::runtime_error if spheres_n spheres don't fit below max.y.
+void Simulator::add_sphere_block(const glm::vec3 &min, const glm::vec3 &max, unsigned int spheres_n)
+{
+  const float spacing = get_block_spacing();
+  const size_t nx = std::max<size_t>(1, (size_t)((max.x - min.x) / spacing));
+  const size_t nz = std::max<size_t>(1, (size_t)((max.z - min.z) / spacing));
+  const size_t layers_n = (size_t)((max.y - min.y) / spacing);
+
+  if (spheres_n > nx * nz * layers_n)
+  {
+    throw std::runtime_error(std::to_string(spheres_n) + " spheres don't fit the scene's block of " + std::to_string(nx * nz * layers_n));
+  }
+
+  for (unsigned int i = 0; i < spheres_n; ++i)
+  {
+    glm::vec3 pos = min + glm::vec3(i % nx + .5f, i / (nx * nz) + .5f, (i / nx) % nz + .5f) * spacing;
+    pos.x += get_rand(-.05f, .05f) * sphere_rad_;
+    pos.z += get_rand(-.05f, .05f) * sphere_rad_;
+
+    add_sphere(pos, glm::vec3(0.f));
+  }
+}
+
+void Simulator::init_gas()
+{
   const glm::vec3 dims = engine_.get_world_dims();
   float w = dims.x / 3.f;
   float h = dims.y / 3.f;
   float d = dims.z / 3.f;
-  const bool small_start = false;
 
-  // add spheres
-  for (unsigned int i = 0; i < spheres_n_; ++i)
+  // one draw per statement, argument evaluation order is unspecified.
+  std::vector<glm::vec3> positions(spheres_n_);
+  for (glm::vec3 &pos : positions)
   {
-    if (small_start)
-      elem_indices.push_back(engine_.add_sphere(get_rand(), get_rand(), get_rand(), false, true));
-    else
-      elem_indices.push_back(engine_.add_sphere(get_rand(-w, w), get_rand(-h, h), get_rand(-d, d), false, true));
+    pos.x = get_rand(-w, w);
+    pos.y = get_rand(-h, h);
+    pos.z = get_rand(-d, d);
+  }
+  for (const glm::vec3 &pos : positions)
+  {
+    glm::vec3 vel;
+    vel.x = get_rand(-.2f, .2f);
+    vel.y = get_rand(-.2f, .2f);
+    vel.z = get_rand(-.2f, .2f);
+    add_sphere(pos, vel);
   }
 
-  for (size_t ind : elem_indices)
+  positions.resize(boxes_n_);
+  for (glm::vec3 &pos : positions)
   {
-    Sphere *s = engine_.get_sphere(ind);
-    s->set_initial_vel(glm::vec3(get_rand(-.2f, .2f), get_rand(-.2f, .2f), get_rand(-.2f, .2f)));
-    spheres_.push_back(s);
+    pos.x = get_rand(-w, w);
+    pos.y = get_rand(-h, h);
+    pos.z = get_rand(-d, d);
   }
+  for (const glm::vec3 &pos : positions)
+  {
+    glm::vec3 vel;
+    vel.x = get_rand(-.5f, .5f);
+    vel.y = get_rand(-.5f, .5f);
+    vel.z = get_rand(-.9f, .9f);
+    add_box(pos, vel);
+  }
+}
+
+void Simulator::init_pile()
+{
+  const glm::vec3 half = engine_.get_world_dims() / 2.f;
+  const float spacing = get_block_spacing();
+
+  // widened from .3 of the world until spheres_n fit, add_sphere_block() throws past the walls.
+  const size_t layers_n = std::max<size_t>(1, (size_t)(2.f * half.y / spacing));
+  const size_t per_layer = (spheres_n_ + layers_n - 1) / layers_n;
+  const size_t side_n = (size_t)std::ceil(std::sqrt((double)per_layer));
+  const float column = std::min(half.x, std::max(.3f * half.x, side_n * spacing / 2.f + .01f * spacing));
+
+  add_sphere_block(glm::vec3(-column, -half.y, -column), glm::vec3(column, half.y, column), spheres_n_);
+}
+
+void Simulator::init_tower()
+{
+  static constexpr float BOX_SIZE = .4f;
+  static constexpr float GAP = .001f;
+  const glm::vec3 half = engine_.get_world_dims() / 2.f;
 
-  // add boxes
-  elem_indices.clear();
   for (unsigned int i = 0; i < boxes_n_; ++i)
   {
-    elem_indices.push_back(engine_.add_box(glm::vec3(get_rand(-w, w), get_rand(-h, h), get_rand(-d, d)), glm::vec3(.4f, .4f, .4f), false, true));
+    glm::vec3 pos(0.f, -half.y + (i + .5f) * (BOX_SIZE + GAP), 0.f);
+    pos.x = get_rand(-.01f, .01f);
+    pos.z = get_rand(-.01f, .01f);
+    add_box(pos, glm::vec3(0.f));
   }
+}
 
-  for (size_t ind : elem_indices)
+void Simulator::init_mixed()
+{
+  // the upper half, so everything falls and piles up.
+  const glm::vec3 half = engine_.get_world_dims() / 2.f - glm::vec3(.4f);
+  const unsigned int shapes_n = spheres_n_ + boxes_n_;
+
+  for (unsigned int i = 0; i < shapes_n; ++i)
   {
-    Box *b = engine_.get_box(ind);
-    b->set_initial_vel(glm::vec3(get_rand(-.5f, .5f), get_rand(-.5f, .5f), get_rand(-.9f, .9f)));
-    boxes_.push_back(b);
+    glm::vec3 pos;
+    pos.x = get_rand(-half.x, half.x);
+    pos.y = get_rand(0.f, half.y);
+    pos.z = get_rand(-half.z, half.z);
+
+    // alternate while both kinds are left.
+    const unsigned int spheres_added = (unsigned int)spheres_.size();
+    const unsigned int boxes_added = (unsigned int)boxes_.size();
+    if (spheres_added < spheres_n_ && (boxes_added == boxes_n_ || i % 2 == 0))
+      add_sphere(pos, glm::vec3(0.f));
+    else
+      add_box(pos, glm::vec3(0.f));
   }
+}
+
+void Simulator::init_dam_break()
+{
+  // a quarter of the world's width, wider if spheres_n don't fit, all of its depth.
+  const glm::vec3 half = engine_.get_world_dims() / 2.f;
+  const float spacing = get_block_spacing();
+  const size_t layers_n = std::max<size_t>(1, (size_t)(2.f * half.y / spacing));
+  const size_t nz = std::max<size_t>(1, (size_t)(2.f * half.z / spacing));
+  const size_t rows_n = (spheres_n_ + layers_n * nz - 1) / (layers_n * nz);
+  const float width = std::min(2.f * half.x, std::max(half.x / 2.f, rows_n * spacing + .01f * spacing));
+
+  add_sphere_block(-half, glm::vec3(-half.x + width, half.y, half.z), spheres_n_);
+}
+
+void Simulator::init_boundaries()
+{
+  const glm::vec3 dims = engine_.get_world_dims();
 
-  // add boundaries
   const glm::vec3 center = engine_.get_world_center();
   Box *floor = engine_.get_box(engine_.add_box(center + glm::vec3(0.f, -dims.y, 0.f), dims, true, false));
   Box *ceiling = engine_.get_box(engine_.add_box(center + glm::vec3(0.f, dims.y, 0.f), dims, true, false));
@@ -423,7 +597,10 @@ void Simulator::init()
   boxes_.push_back(front);
   boxes_.push_back(right);
   boxes_.push_back(left);
+}
 
+void Simulator::init_bodies()
+{
   for (size_t i = 0; i < boxes_.size(); ++i)
   {
     Box *box = boxes_[i];
@@ -456,8 +633,6 @@ void Simulator::init()
 
     reactphysics3d::Collider *collider = body->addCollider(shape, reactphysics3d::Transform::identity());
   }
-
-  debug_line_ = engine_.get_line(engine_.add_line(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, 0.f)));
 }
 
 static void print_fps()
@@ -476,19 +651,50 @@ static void print_fps()
     cr::microseconds diff_from_last_frame = cr::duration_cast<cr::microseconds>(current - previous);
     std::cout << "frame num:" << frame_cnt << ", Time to process last frame (milliseconds): " << diff_from_last_frame.count() / 1000.0
               << " FPS: " << 1.0 / ((double)diff_from_last_frame.count() / 1000'000.0) << "\n";
+
+#ifdef BE_PROFILE
+    // a single frame says little, add the rolling stats per scope.
+    for (const auto &s : Profiler::get().get_stats())
+    {
+      std::cout << "  " << std::string(2 * s.depth, ' ') << (s.gpu ? "gpu " : "") << s.name
+                << " ms: last " << s.last_ms << ", min " << s.min_ms << ", mean " << s.mean_ms << ", p99 " << s.p99_ms << "\n";
+    }
+#endif
+
+#ifdef BE_SIM_STATS
+    for (const SimStats::Value &v : SimStats::get().get_values())
+    {
+      std::cout << "  " << v.name << ": " << v.value;
+      if (v.kind == SimStats::Kind::histogram)
+        std::cout << " mean of " << v.samples_n << ", max " << v.max;
+      std::cout << "\n";
+    }
+#endif
+
+#ifdef BE_TRACK_ALLOCS
+    AllocTracker::Counts allocs = AllocTracker::get().get_step_counts();
+    std::cout << "  step allocations: " << allocs.allocs << ", bytes: " << allocs.bytes << "\n";
+    for (const AllocTracker::Phase &phase : AllocTracker::get().get_phases())
+    {
+      if (phase.counts.allocs > 0)
+        std::cout << "    " << phase.name << ": " << phase.counts.allocs << ", bytes: " << phase.counts.bytes << "\n";
+    }
+#endif
   }
   previous = current;
 }
 
-void Simulator::run()
+void Simulator::run(size_t frames_n)
 {
+  engine_.set_frame_limit(frames_n);
+
   while (!engine_.loop_done())
   {
-    handle_collisions();
-
-    integrate();
+    step(offscreen_ ? get_fixed_h() : get_frame_h());
 
-    kinematics();
+    // the demo arrows follow the wall clock, offscreen frames only depend on the seed.
+    if (!offscreen_)
+      kinematics();
 
     engine_.draw();
 
@@ -506,7 +712,8 @@ void Simulator::key_callback(int key, int scancode, int action, int mods)
     {
       std::cout << "P press!!!\n";
 
-      glm::vec3 force(get_rand(-1.f, 1.f), .5f, get_rand(-1.f, 1.f));
+      glm::vec3 force(get_rand(-1.f, 1.f), .5f, 0.f);
+      force.z = get_rand(-1.f, 1.f);
       std::cout << "adding:(" << force.x << "," << force.y << "," << force.z << "\n";
       add_global_force("P-force", force);
     }
@@ -531,7 +738,8 @@ void Simulator::key_callback(int key, int scancode, int action, int mods)
     {
       std::cout << "T press!!!\n";
 
-      glm::vec3 torque(get_rand(-.1f, .1f), .5f, get_rand(-.1f, .1f));
+      glm::vec3 torque(get_rand(-.1f, .1f), .5f, 0.f);
+      torque.z = get_rand(-.1f, .1f);
       std::cout << "adding:(" << torque.x << "," << torque.y << "," << torque.z << "\n";
       add_global_torque("torque", torque);
     }
@@ -559,6 +767,26 @@ void Simulator::key_callback(int key, int scancode, int action, int mods)
     }
   }
   break;
+  case GLFW_KEY_N:
+  {
+    if (action == GLFW_PRESS)
+    {
+      // toggle contact normals
+      DebugLines::set_enabled(!DebugLines::is_enabled());
+    }
+  }
+  break;
+  case GLFW_KEY_I:
+  {
+    if (action == GLFW_PRESS)
+    {
+      // toggle sphere impostors
+      BadEngine::RenderMode mode = engine_.get_render_mode(BadEngine::RenderableType::sphere);
+      engine_.set_render_mode(BadEngine::RenderableType::sphere,
+                              mode == BadEngine::RenderMode::impostor ? BadEngine::RenderMode::mesh : BadEngine::RenderMode::impostor);
+    }
+  }
+  break;
   case GLFW_KEY_E:
   {
     if (action == GLFW_PRESS)
@@ -6,16 +6,43 @@
 #include "Line.h"
 #include "CollisionSolver.h"
 #include "ImpulseCollisionSolver.h"
+#include "SimStats.h"
 
 #include <vector>
 #include <map>
+#include <random>
 #include <reactphysics3d/reactphysics3d.h>
 
 
 class Simulator
 {
 public:
-  Simulator(unsigned int spheres_n, unsigned int boxes_n);
+  // initial layouts, all inside the world's boundaries and under gravity. init() throws
+  // std::runtime_error if the pile or dam_break block can't hold the spheres.
+  enum class Scene
+  {
+    gas = 0,   // spheres and boxes at random positions and velocities
+    pile,      // spheres dropped in a column onto the floor
+    tower,     // a stack of boxes
+    mixed,     // spheres and boxes falling from random positions
+    dam_break, // a block of spheres released from one side of the world
+  };
+
+  struct StepStats
+  {
+    double collision_detection_ms = 0.;
+    double solver_ms = 0.;
+    double integrate_ms = 0.;
+    double transform_sync_ms = 0.; // part of integrate_ms
+    size_t contacts = 0;           // found by the first detection pass
+    unsigned int solver_iterations = 0;
+    uint64_t allocs = 0;      // BE_TRACK_ALLOCS builds only
+    uint64_t alloc_bytes = 0; // BE_TRACK_ALLOCS builds only
+  };
+
+public:
+  // the same seed gives the same scene, and with fixed steps the same simulation.
+  Simulator(unsigned int spheres_n, unsigned int boxes_n, unsigned int seed = 1);
   ~Simulator();
 
 public:
@@ -25,11 +52,38 @@ public:
   void remove_global_torque(const std::string &name);
 
 public:
-  void run();
-  void init();
+  // steps and draws until the window closes, or for frames_n frames. offscreen, frames_n is
+  // required, every frame steps by get_fixed_h() and the clock driven demo arrows are left
+  // out, so the same seed draws the same frames.
+  void run(size_t frames_n = 0);
+  // headless creates no window or GL context, only step() may be used then.
+  void init(Scene scene = Scene::gas, bool headless = false, BadEngine::Backend backend = BadEngine::Backend::window);
+  // e.g. to capture the frames of an offscreen run.
+  BadEngine &get_engine() { return engine_; }
+  // collisions and integration by h, without kinematic objects or drawing.
+  StepStats step(float h);
+  // the step run() takes at 60 frames per second.
+  float get_fixed_h() const { return base_h_ * 133.33f / 60.f; }
+  const std::vector<Sphere *> &get_spheres() const { return spheres_; }
+  const std::vector<Box *> &get_boxes() const { return boxes_; }
+  // counters and histograms of the last step, empty without BE_SIM_STATS.
+  const std::vector<SimStats::Value> &get_sim_stats() const { return SimStats::get().get_values(); }
 
 private:
-  void integrate();
+  float get_frame_h();
+  float get_rand(float low = -.5f, float high = .5f);
+  void add_sphere(const glm::vec3 &pos, const glm::vec3 &vel);
+  void add_box(const glm::vec3 &pos, const glm::vec3 &vel);
+  // between the sphere centers of add_sphere_block()'s lattice.
+  float get_block_spacing() const { return 2.2f * sphere_rad_; }
+  void add_sphere_block(const glm::vec3 &min, const glm::vec3 &max, unsigned int spheres_n);
+  void init_gas();
+  void init_pile();
+  void init_tower();
+  void init_mixed();
+  void init_dam_break();
+  void init_boundaries();
+  void init_bodies();
   void integrate_spheres(float h);
   void integrate_shapes(float h);
   void handle_collisions();
@@ -46,6 +100,10 @@ private:
   unsigned int boxes_n_;
   float sphere_rad_;
   double last_time_ = -1.;
+  bool headless_ = false;
+  bool offscreen_ = false;
+  std::mt19937 rng_;
+  StepStats step_stats_;
   BadEngine engine_;
   std::map<std::string, glm::vec3> g_forces_;  // named forces
   std::map<std::string, glm::vec3> g_torques_; // named torques
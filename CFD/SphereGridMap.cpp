@@ -1,32 +1,45 @@
 #include "SphereGridMap.h"
+#include "SimStats.h"
 
 
-void SphereGridMap::update_map(const std::vector<Sphere *> &spheres)
+void SphereGridMap::update_map(const std::vector<Particle> &particles)
 {
   map_.clear();
 
-  for (Sphere *s : spheres)
+  for (uint32_t i = 0; i < (uint32_t)particles.size(); ++i)
   {
-    insert(s);
+    insert(i, particles[i].p);
   }
+
+#ifdef BE_SIM_STATS
+  // spheres per occupied cell, equal keys are adjacent in a multimap.
+  for (auto it = map_.begin(); it != map_.end();)
+  {
+    size_t cell = it->first;
+    size_t n = 0;
+    for (; it != map_.end() && it->first == cell; ++it)
+      n++;
+    SIM_STAT_HISTOGRAM("grid occupancy", n, 1.);
+  }
+#endif
 }
 
-void SphereGridMap::get_neighbours_by_coords(const Sphere *s, std::list<Sphere *> &vec, const glm::uvec3 &coords) const
+void SphereGridMap::get_neighbours_by_coords(uint32_t idx, std::vector<uint32_t> &vec, const glm::uvec3 &coords) const
 {
   auto r = map_.equal_range(get_flat_idx(coords));
 
   for (auto it = r.first; it != r.second; ++it)
   {
-    if ((*it).second != s)
+    if ((*it).second != idx)
     {
       vec.push_back((*it).second);
     }
   }
 }
 
-void SphereGridMap::get_neighbours(const Sphere *s, std::list<Sphere *> &res) const
+void SphereGridMap::get_neighbours(uint32_t idx, const glm::vec3 &pos, std::vector<uint32_t> &res) const
 {
-  auto coords = get_3d_idx(s->get_pos());
+  auto coords = get_3d_idx(pos);
 
   size_t x_inf = (coords.x > 0) ? coords.x - 1 : coords.x;
   size_t x_sup = (coords.x + 1 <= world_cells_n_.x) ? coords.x + 1 : coords.x;
@@ -50,19 +63,19 @@ void SphereGridMap::get_neighbours(const Sphere *s, std::list<Sphere *> &res) co
            z <= z_sup;
            ++z)
       {
-        get_neighbours_by_coords(s, res, glm::uvec3(x, y, z));
+        get_neighbours_by_coords(idx, res, glm::uvec3(x, y, z));
       }
     }
   }
 }
 
-size_t SphereGridMap::insert(Sphere *s)
+size_t SphereGridMap::insert(uint32_t idx, const glm::vec3 &pos)
 {
-  size_t idx = get_flat_idx(s->get_pos());
+  size_t cell = get_flat_idx(pos);
 
-  map_.emplace(idx, s);
+  map_.emplace(cell, idx);
 
-  return idx;
+  return cell;
 }
 
 /**
@@ -4,8 +4,8 @@
 #include <unordered_map>
 #include <gl_incs.h>
 #include <vector>
-#include <list>
-#include "Sphere.h"
+#include <cstdint>
+#include "Particle.h"
 
 class SphereGridMap
 {
@@ -17,21 +17,23 @@ public:
   { }
 
 public:
-  void update_map(const std::vector<Sphere *> &spheres);
-  void get_neighbours(const Sphere *s, std::list<Sphere *> &res) const;
+  // the map holds indices into particles.
+  void update_map(const std::vector<Particle> &particles);
+  // appends the particles in the cells around pos, except idx.
+  void get_neighbours(uint32_t idx, const glm::vec3 &pos, std::vector<uint32_t> &res) const;
 
 private:
-  size_t insert(Sphere *s);
+  size_t insert(uint32_t idx, const glm::vec3 &pos);
   size_t get_flat_idx(const glm::vec3 &pos) const;
 
 private:
   glm::uvec3 get_3d_idx(const glm::vec3 &pos) const;
   size_t get_flat_idx(size_t a, size_t b, size_t c) const;
   size_t get_flat_idx(const glm::uvec3 &coords) const;
-  void get_neighbours_by_coords(const Sphere *s, std::list<Sphere *> &vec, const glm::uvec3 &coords) const;
+  void get_neighbours_by_coords(uint32_t idx, std::vector<uint32_t> &vec, const glm::uvec3 &coords) const;
 
 private:
-  std::unordered_multimap<size_t, Sphere *> map_;
+  std::unordered_multimap<size_t, uint32_t> map_;
   const float rad_;
   glm::vec3 world_dims_; // x=w, y=h, z=d
   const glm::vec3 cell_dims_; // x=w, y=h, z=d